@@ -1,4 +1,19 @@
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
 
 /**
  * @file solution_g.cpp
@@ -52,9 +67,466 @@
  * e. Print "YES" if the condition is true, and "NO" otherwise.
  * This approach has a time complexity of $O(q)$ since each query is processed in constant time,
  * making it well within the time limit.
+ * # Batch mode
+ * With `--batch` the same check runs over very long throw streams. The input is read in large
+ * blocks and parsed by hand into structure-of-arrays buffers of `BATCH` throws. All coordinates
+ * fit in 32 bits, so they are stored that way and widened to 64 bits inside the kernel, where
+ * $2x_B - x_A$ and the four comparisons against the table are done on 4 (AVX2) or 2 (SSE4.2)
+ * throws at once. The kernel is picked at run time from what the CPU supports, with a scalar
+ * fallback; `--batch scalar|sse|avx2` forces one. The answers of a whole batch are copied into
+ * a preformatted output buffer and written with a single `fwrite`.
+ * # File input
+ * `--mmap <file> [kernel]` maps the input file instead of reading standard input. A text file is
+ * scanned in place, straight from the mapped pages. `--to-binary` converts the text input into a
+ * binary throw file (see `ThrowFileHeader`): there the throws are already stored as the 32-bit
+ * arrays the kernels read, so `--mmap` hands each block of the mapping to the kernel without
+ * parsing or copying anything.
+ * # Many tables
+ * With `--tables` the first line holds the number of tables $T$, followed by $T$ lines
+ * $x_{min}$ $x_{max}$ $y_{min}$ $y_{max}$, and then $q$ and the throws as usual. For each throw the
+ * output is the (1-based) number of the first table the ball lands on, or 0 if it misses them all.
+ * The tables are stored in a static packed R-tree: they are sorted into tiles (sort-tile-recursive)
+ * and grouped `FANOUT` at a time, each group becoming a node with the bounding box of its children,
+ * up to a single root. A landing point only descends into the nodes whose box contains it, so with
+ * disjoint tables a query visits $O(\log T)$ nodes instead of scanning all $T$ tables. Each node also
+ * keeps the smallest table number below it, which prunes subtrees once a better table is found.
  */
 
-int main() {
+/**
+ * @brief The table, as the inclusive bounds of the rectangle.
+ */
+struct Table {
+    long long x_min, x_max, y_min, y_max;
+};
+
+/**
+ * @brief A block of at most `BATCH` throws in structure-of-arrays form, as seen by the kernels.
+ * $z_B$ does not affect the landing point and is not stored.
+ */
+const int BATCH = 1 << 14;
+struct ThrowView {
+    const std::int32_t *x_a, *y_a, *x_b, *y_b;
+    int size;
+};
+
+/**
+ * @brief Storage for one block of parsed throws.
+ */
+struct ThrowBatch {
+    std::int32_t x_a[BATCH], y_a[BATCH], x_b[BATCH], y_b[BATCH];
+    int size = 0;
+
+    ThrowView view() const { return ThrowView{x_a, y_a, x_b, y_b, size}; }
+};
+
+/**
+ * @brief Sets `lands[i]` to 1 if throw `i` lands on the table and to 0 otherwise, for
+ * `from <= i < b.size`.
+ */
+void lands_scalar(const ThrowView& b, const Table& t, std::uint8_t* lands, int from = 0) {
+    for (int i = from; i < b.size; ++i) {
+        long long x_c = 2LL * b.x_b[i] - b.x_a[i];
+        long long y_c = 2LL * b.y_b[i] - b.y_a[i];
+        lands[i] = x_c >= t.x_min && x_c <= t.x_max && y_c >= t.y_min && y_c <= t.y_max;
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+/**
+ * @brief `lands_scalar()` on 2 throws at a time; `_mm_cmpgt_epi64` needs SSE4.2.
+ */
+__attribute__((target("sse4.2")))
+void lands_sse42(const ThrowView& b, const Table& t, std::uint8_t* lands, int from = 0) {
+    const __m128i x_lo = _mm_set1_epi64x(t.x_min), x_hi = _mm_set1_epi64x(t.x_max);
+    const __m128i y_lo = _mm_set1_epi64x(t.y_min), y_hi = _mm_set1_epi64x(t.y_max);
+    int i = from;
+    for (; i + 2 <= b.size; i += 2) {
+        // Sign-extend two 32-bit coordinates to 64-bit lanes
+        __m128i xa = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(b.x_a + i)));
+        __m128i ya = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(b.y_a + i)));
+        __m128i xb = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(b.x_b + i)));
+        __m128i yb = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(b.y_b + i)));
+        __m128i xc = _mm_sub_epi64(_mm_add_epi64(xb, xb), xa);
+        __m128i yc = _mm_sub_epi64(_mm_add_epi64(yb, yb), ya);
+
+        // A lane misses the table if it crosses any of the four bounds
+        __m128i miss = _mm_or_si128(
+            _mm_or_si128(_mm_cmpgt_epi64(x_lo, xc), _mm_cmpgt_epi64(xc, x_hi)),
+            _mm_or_si128(_mm_cmpgt_epi64(y_lo, yc), _mm_cmpgt_epi64(yc, y_hi)));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(miss));
+        lands[i] = !(mask & 1);
+        lands[i + 1] = !(mask >> 1 & 1);
+    }
+    lands_scalar(b, t, lands, i);
+}
+
+/**
+ * @brief `lands_scalar()` on 4 throws at a time with AVX2.
+ */
+__attribute__((target("avx2")))
+void lands_avx2(const ThrowView& b, const Table& t, std::uint8_t* lands, int from = 0) {
+    const __m256i x_lo = _mm256_set1_epi64x(t.x_min), x_hi = _mm256_set1_epi64x(t.x_max);
+    const __m256i y_lo = _mm256_set1_epi64x(t.y_min), y_hi = _mm256_set1_epi64x(t.y_max);
+    int i = from;
+    for (; i + 4 <= b.size; i += 4) {
+        __m256i xa = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(b.x_a + i)));
+        __m256i ya = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(b.y_a + i)));
+        __m256i xb = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(b.x_b + i)));
+        __m256i yb = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(b.y_b + i)));
+        __m256i xc = _mm256_sub_epi64(_mm256_add_epi64(xb, xb), xa);
+        __m256i yc = _mm256_sub_epi64(_mm256_add_epi64(yb, yb), ya);
+
+        __m256i miss = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpgt_epi64(x_lo, xc), _mm256_cmpgt_epi64(xc, x_hi)),
+            _mm256_or_si256(_mm256_cmpgt_epi64(y_lo, yc), _mm256_cmpgt_epi64(yc, y_hi)));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(miss));
+        for (int k = 0; k < 4; ++k) lands[i + k] = !(mask >> k & 1);
+    }
+    lands_scalar(b, t, lands, i);
+}
+#endif
+
+typedef void (*LandingKernel)(const ThrowView&, const Table&, std::uint8_t*, int);
+
+/**
+ * @brief Picks the widest kernel the CPU supports, or the one named by `force`.
+ */
+LandingKernel pick_kernel(std::string force) {
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2"), sse42 = __builtin_cpu_supports("sse4.2");
+    if (force.empty()) force = avx2 ? "avx2" : sse42 ? "sse" : "scalar";
+    if (force == "avx2" && avx2) return lands_avx2;
+    if (force == "sse" && sse42) return lands_sse42;
+#endif
+    return lands_scalar;
+}
+
+/**
+ * @brief Integer scanner over standard input, read in blocks, or over a memory-mapped file.
+ * * When reading a mapping the scanner walks the mapped pages directly and `refill()` only
+ * reports the end, so nothing is copied.
+ */
+struct InputReader {
+    static const size_t SIZE = 1 << 16;
+    std::vector<char> storage;  // only used for standard input
+    const char* p = nullptr;
+    const char* end = nullptr;
+
+    InputReader() : storage(SIZE) {}
+    InputReader(const char* data, size_t len) : p(data), end(data + len) {}
+
+    bool refill() {
+        if (storage.empty()) return false;
+        size_t len = std::fread(storage.data(), 1, SIZE, stdin);
+        p = storage.data();
+        end = p + len;
+        return len > 0;
+    }
+
+    int peek() {
+        if (p == end && !refill()) return EOF;
+        return *p;
+    }
+
+    // Reads the next (possibly negative) integer; returns false at end of input
+    bool read(long long& v) {
+        int c;
+        while ((c = peek()) != EOF && c != '-' && (unsigned)(c - '0') > 9) ++p;
+        if (c == EOF) return false;
+        bool neg = c == '-';
+        if (neg) ++p;
+        v = 0;
+        while ((unsigned)((c = peek()) - '0') <= 9) {
+            v = v * 10 + (c - '0');
+            ++p;
+        }
+        if (neg) v = -v;
+        return true;
+    }
+};
+
+/**
+ * @brief Prints "YES" or "NO" for each of the `n` answers with a single `fwrite`.
+ */
+void write_answers(const std::uint8_t* lands, int n) {
+    static char out[4 * BATCH];  // "YES\n" is the longest answer
+    char* p = out;
+    for (int i = 0; i < n; ++i) {
+        if (lands[i]) {
+            std::memcpy(p, "YES\n", 4);
+            p += 4;
+        } else {
+            std::memcpy(p, "NO\n", 3);
+            p += 3;
+        }
+    }
+    std::fwrite(out, 1, p - out, stdout);
+}
+
+/**
+ * @brief Parses, checks and prints the throws in `in` one `ThrowBatch` at a time.
+ */
+void run_batch(InputReader& in, LandingKernel kernel) {
+    static ThrowBatch b;
+    static std::uint8_t lands[BATCH];
+
+    Table t;
+    long long q = 0;
+    in.read(t.x_min);
+    in.read(t.x_max);
+    in.read(t.y_min);
+    in.read(t.y_max);
+    in.read(q);
+
+    long long v[5];
+    while (q > 0) {
+        b.size = 0;
+        while (b.size < BATCH && q > 0) {
+            for (long long& x : v) in.read(x);
+            b.x_a[b.size] = (std::int32_t)v[0];
+            b.y_a[b.size] = (std::int32_t)v[1];
+            b.x_b[b.size] = (std::int32_t)v[2];
+            b.y_b[b.size] = (std::int32_t)v[3];
+            ++b.size;
+            --q;
+        }
+        kernel(b.view(), t, lands, 0);
+        write_answers(lands, b.size);
+    }
+}
+
+/**
+ * @brief Header of a binary throw file.
+ * * The header is followed by the throws in blocks of `BATCH` (the last one may be shorter). Each
+ * block holds its $x_A$, $y_A$, $x_B$ and $y_B$ values as four consecutive arrays of 32-bit
+ * integers, so a block is used in place as a `ThrowView`. Values are little-endian, which is
+ * the native order of the machines this runs on; `magic` guards against other files.
+ */
+struct ThrowFileHeader {
+    char magic[8];
+    std::int64_t x_min, x_max, y_min, y_max, q;
+};
+
+const char THROW_MAGIC[8] = {'P', 'G', 'T', 'H', 'R', 'O', 'W', '1'};
+
+/**
+ * @brief Converts the text input on standard input to a binary throw file on standard output
+ * (`--to-binary` mode).
+ */
+void to_binary() {
+    static InputReader in;
+    static ThrowBatch b;
+
+    ThrowFileHeader h = {};
+    std::memcpy(h.magic, THROW_MAGIC, 8);
+    long long v[5];
+    for (int i = 0; i < 5; ++i) in.read(v[i]);
+    h.x_min = v[0], h.x_max = v[1], h.y_min = v[2], h.y_max = v[3], h.q = v[4];
+    std::fwrite(&h, sizeof(h), 1, stdout);
+
+    for (long long q = h.q; q > 0;) {
+        b.size = 0;
+        for (; b.size < BATCH && q > 0; --q, ++b.size) {
+            for (long long& x : v) in.read(x);
+            b.x_a[b.size] = (std::int32_t)v[0];
+            b.y_a[b.size] = (std::int32_t)v[1];
+            b.x_b[b.size] = (std::int32_t)v[2];
+            b.y_b[b.size] = (std::int32_t)v[3];
+        }
+        std::fwrite(b.x_a, 4, b.size, stdout);
+        std::fwrite(b.y_a, 4, b.size, stdout);
+        std::fwrite(b.x_b, 4, b.size, stdout);
+        std::fwrite(b.y_b, 4, b.size, stdout);
+    }
+}
+
+/**
+ * @brief Maps `path` read-only and answers its throws (`--mmap` mode).
+ * * A binary throw file is handed to the kernel block by block straight from the mapping; any
+ * other file is scanned as text in place.
+ * @return `false` if the file cannot be mapped or a binary file is truncated.
+ */
+bool run_mapped(const char* path, LandingKernel kernel) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    madvise(base, st.st_size, MADV_SEQUENTIAL);
+
+    const char* data = static_cast<const char*>(base);
+    size_t size = st.st_size;
+    bool ok = true;
+    if (size >= sizeof(ThrowFileHeader) && std::memcmp(data, THROW_MAGIC, 8) == 0) {
+        ThrowFileHeader h;
+        std::memcpy(&h, data, sizeof(h));
+        Table t = {h.x_min, h.x_max, h.y_min, h.y_max};
+        ok = h.q >= 0 && size == sizeof(h) + 16 * (size_t)h.q;
+
+        static std::uint8_t lands[BATCH];
+        const std::int32_t* block = reinterpret_cast<const std::int32_t*>(data + sizeof(h));
+        for (long long q = h.q; ok && q > 0; q -= BATCH) {
+            int n = (int)std::min<long long>(q, BATCH);
+            ThrowView view = {block, block + n, block + 2 * n, block + 3 * n, n};
+            kernel(view, t, lands, 0);
+            write_answers(lands, n);
+            block += 4 * n;
+        }
+    } else {
+        InputReader in(data, size);
+        run_batch(in, kernel);
+    }
+    munmap(base, size);
+    return ok;
+}
+
+/**
+ * @brief Static packed R-tree over the tables (`--tables` mode).
+ * * `levels[0]` holds the tables themselves, in tile order; node `i` of `levels[k]` covers nodes
+ * `i * FANOUT` to `(i + 1) * FANOUT - 1` of `levels[k - 1]`. `first[k][i]` is the smallest table
+ * number under that node.
+ */
+struct PackedRTree {
+    static const int FANOUT = 16;
+    std::vector<std::vector<Table>> levels;
+    std::vector<std::vector<int>> first;
+
+    explicit PackedRTree(const std::vector<Table>& tables) {
+        int n = tables.size();
+        std::vector<int> order(n);
+        for (int i = 0; i < n; ++i) order[i] = i;
+
+        // Sort-tile-recursive: vertical slices by x centre, each slice sorted by y centre
+        auto cx = [&](int i) { return tables[i].x_min + tables[i].x_max; };
+        auto cy = [&](int i) { return tables[i].y_min + tables[i].y_max; };
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return cx(a) < cx(b); });
+        int leaves = (n + FANOUT - 1) / FANOUT;
+        int slices = 1;
+        while ((long long)slices * slices < leaves) ++slices;
+        int per_slice = slices * FANOUT;
+        for (int from = 0; from < n; from += per_slice) {
+            int to = std::min(n, from + per_slice);
+            std::sort(order.begin() + from, order.begin() + to,
+                      [&](int a, int b) { return cy(a) < cy(b); });
+        }
+
+        levels.emplace_back(n);
+        first.emplace_back(n);
+        for (int i = 0; i < n; ++i) {
+            levels[0][i] = tables[order[i]];
+            first[0][i] = order[i] + 1;
+        }
+
+        while (levels.back().size() > 1) {
+            const std::vector<Table>& below = levels.back();
+            const std::vector<int>& below_first = first.back();
+            int m = (below.size() + FANOUT - 1) / FANOUT;
+            std::vector<Table> box(m);
+            std::vector<int> low(m, INT_MAX);
+            for (int i = 0; i < m; ++i) {
+                box[i] = {LLONG_MAX, LLONG_MIN, LLONG_MAX, LLONG_MIN};
+                for (int c = i * FANOUT; c < std::min<int>(below.size(), (i + 1) * FANOUT); ++c) {
+                    box[i].x_min = std::min(box[i].x_min, below[c].x_min);
+                    box[i].x_max = std::max(box[i].x_max, below[c].x_max);
+                    box[i].y_min = std::min(box[i].y_min, below[c].y_min);
+                    box[i].y_max = std::max(box[i].y_max, below[c].y_max);
+                    low[i] = std::min(low[i], below_first[c]);
+                }
+            }
+            levels.push_back(std::move(box));
+            first.push_back(std::move(low));
+        }
+    }
+
+    /**
+     * @return The smallest number of a table containing (x, y), or 0 if there is none.
+     */
+    int query(long long x, long long y) const {
+        if (levels[0].empty()) return 0;
+        int best = INT_MAX;
+        search(levels.size() - 1, 0, x, y, best);
+        return best == INT_MAX ? 0 : best;
+    }
+
+    void search(int level, int i, long long x, long long y, int& best) const {
+        const Table& b = levels[level][i];
+        if (first[level][i] >= best) return;
+        if (x < b.x_min || x > b.x_max || y < b.y_min || y > b.y_max) return;
+        if (level == 0) {
+            best = first[0][i];
+            return;
+        }
+        int end = std::min<int>(levels[level - 1].size(), (i + 1) * FANOUT);
+        for (int c = i * FANOUT; c < end; ++c) search(level - 1, c, x, y, best);
+    }
+};
+
+/**
+ * @brief Many-tables mode: prints for each throw the first table it lands on, or 0.
+ */
+void run_tables() {
+    static InputReader in;
+    long long t = 0;
+    in.read(t);
+    std::vector<Table> tables(t);
+    for (Table& r : tables) {
+        in.read(r.x_min);
+        in.read(r.x_max);
+        in.read(r.y_min);
+        in.read(r.y_max);
+    }
+    PackedRTree tree(tables);
+
+    long long q = 0;
+    in.read(q);
+    std::vector<char> out;
+    out.reserve(1 << 16);
+    char digits[16];
+    for (long long v[5]; q > 0; --q) {
+        for (long long& x : v) in.read(x);
+        int hit = tree.query(2 * v[2] - v[0], 2 * v[3] - v[1]);
+
+        int len = 0;
+        do digits[len++] = '0' + hit % 10; while (hit /= 10);
+        while (len > 0) out.push_back(digits[--len]);
+        out.push_back('\n');
+        if (out.size() >= (1 << 16) - 16) {
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            out.clear();
+        }
+    }
+    std::fwrite(out.data(), 1, out.size(), stdout);
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--batch") {
+        static InputReader in;
+        run_batch(in, pick_kernel(argc > 2 ? argv[2] : ""));
+        return 0;
+    }
+    if (mode == "--mmap") {
+        if (argc < 3 || !run_mapped(argv[2], pick_kernel(argc > 3 ? argv[3] : ""))) {
+            std::cerr << "cannot read throw file" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (mode == "--to-binary") {
+        to_binary();
+        return 0;
+    }
+    if (mode == "--tables") {
+        run_tables();
+        return 0;
+    }
+
     // Fast I/O for competitive programming
     std::ios_base::sync_with_stdio(false);
     std::cin.tie(NULL);
@@ -3,7 +3,14 @@
 #include <string>
 #include <numeric>
 #include <algorithm>
-#include <map>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /**
  * @file solution_h.cpp
@@ -30,16 +37,17 @@
  * A brute-force $O(N^2 \cdot \text{max\_len})$ approach is too slow given the constraints.
  * An efficient solution requires a specialized data structure that can handle all strings simultaneously. A
  * **Generalized Suffix Automaton (GSA)** is a suitable choice.
- * The GSA is built by concatenating all strings with unique separator characters. Each state in the GSA
- * represents a set of substrings that are common to the input strings. By traversing the GSA's trie-like
- * structure and its suffix links, we can efficiently count for each substring `p` the number of times it
- * appears as a prefix (`cnt_pref[u]`) and the number of times it appears as a suffix (`cnt_suf[u]`) in the
- * original strings.
- * The total sum for all pairs (including $k=l$) can be computed by iterating through all states `u` of the GSA:
- * $\sum_{k,l} F(s_k, s_l) = \sum_{u} (\text{len}(u) - \text{len}(\text{link}(u))) \times \text{cnt\_suf}[u] \times \text{cnt\_pref}[u]$
+ * The GSA is built by inserting every string from the root, without separator characters. Each state in
+ * the GSA represents a set of substrings that end at exactly the same positions of the input strings, so
+ * they are all suffixes of the same `cnt_suf[u]` strings, obtained by propagating end-of-string counts up
+ * the suffix links.
+ * Prefixes are weighted: the prefix $p$ of $s_l$ contributes $w(p) = |p| - \text{border}(p)$, where
+ * $\text{border}(p)$ is its longest proper border. If $p_1 \supset p_2 \supset \dots$ are the prefixes of $s_l$
+ * that are suffixes of $s_k$, each is the longest border of the previous one, so their weights telescope to
+ * $|p_1| = F(s_k, s_l)$. Accumulating $w$ per state into `cnt_pref[u]` gives, for all pairs (including $k=l$):
+ * $\sum_{k,l} F(s_k, s_l) = \sum_{u} \text{cnt\_suf}[u] \times \text{cnt\_pref}[u]$
  * We then must subtract the cost for pairs where the strings are the same, i.e., $\sum_{k=1}^n F(s_k, s_k)$.
- * $F(s_k, s_k)$ is the length of the longest proper suffix of $s_k$ that is a prefix of $s_k$. This is
- * equivalent to the length of the longest suffix link from the terminal state of $s_k$.
+ * A string is its own suffix and prefix, so $F(s_k, s_k) = |s_k|$ and this is simply $\sum|s_k|$.
  * All calculations are performed modulo $10^9+7$.
  * # Input
  * - The first line contains a single integer $n$ ($2 \le n \le 2 \times 10^5$), the number of strings.
@@ -47,11 +55,25 @@
  * - The sum of all string lengths $\sum|s_i|$ does not exceed $10^6$.
  * # Output
  * - A single integer representing the expected cost modulo $10^9+7$.
+ * # Modes
+ * - `--online`: the corpus grows one string at a time and the expected cost of the strings
+ *   read so far is printed after every insertion. After the first $n$ strings, further batches
+ *   (a count followed by that many strings) are accepted until end of input.
+ * - `--pairs`: after the strings, reads $q$ and then $q$ pairs $k\ l$ (1-based) and prints
+ *   $F(s_k, s_l)$ for each pair, answered offline in one batch.
+ * - `--top`: after the strings, reads $q$ and then $q$ pairs $k\ t$ and prints, for each, up to
+ *   $t$ entries `l:F` naming the strings $l \ne k$ with the largest positive $F(s_k, s_l)$.
+ * - `--save FILE`: builds the automaton as usual, writes a snapshot of it to `FILE` and prints
+ *   the expected cost.
+ * - `--load FILE [--pairs|--top]`: maps a snapshot read-only instead of reading strings, and
+ *   prints the expected cost or answers the queries given on standard input.
+ * - `--sa`: computes the expected cost with the suffix array backend (`sa_expected_cost()`)
+ *   instead of the GSA; on large inputs it needs roughly half of the GSA's memory.
  */
 
-const int MOD = 1e9 + 7;
-const int MAX_LEN = 2e6 + 5; // Sum of lengths + N separators
-const int MAX_STATES = 2 * MAX_LEN;
+// A compile-time constant, so every 64-bit `% MOD` compiles to a multiply-high (Barrett)
+// reduction; 128-bit sums go through `reduce_mod()`, which keeps to 64-bit `%` as well.
+constexpr std::uint32_t MOD = 1000000007;
 
 /**
  * @brief Suffix Automaton Node Structure
@@ -61,7 +83,8 @@ const int MAX_STATES = 2 * MAX_LEN;
  * 
  * - `len`: The length of the longest substring represented by this state.
  * - `link`: The suffix link, pointing to the state representing the largest proper suffix of the current substring.
- * - `next`: A map from characters to the next state, representing transitions for each possible character.
+ * - `edge_begin`, `edge_cnt`, `edge_cap`: The slice of the shared edge pool holding this state's
+ *   transitions (see `edge_char` / `edge_to` below).
  * 
  * The automaton is built incrementally as we process each character of the input strings.
  * The Node struct is essential for efficiently storing and traversing the automaton, allowing us to
@@ -69,21 +92,148 @@ const int MAX_STATES = 2 * MAX_LEN;
  */
 struct Node {
     int len, link;
-    std::map<char, int> next;
+    int edge_begin, edge_cnt, edge_cap;
 };
 
-Node state[MAX_STATES];
+/**
+ * @brief State arena of the automaton.
+ * * States are allocated on demand through `gsa_new_state()`. Before each string is inserted,
+ * `gsa_reserve()` makes room for the states it can create (at most 2 per character), so the
+ * arena is sized from the actual input rather than the worst case and grows geometrically
+ * as strings stream in. `sz` always equals `state.size()`.
+ */
+std::vector<Node> state;
 int sz, last;
 
+/**
+ * @brief Weighted prefix counts, one entry per state (kept in step with `state`).
+ * * When a prefix $p$ of an input string is inserted, `last` is the state whose longest
+ * string is exactly $p$. Later clones only split off shorter strings, so $p$ stays in
+ * that state and its weight $|p| - \text{border}(p)$ can be recorded immediately.
+ */
+std::vector<int> cnt_pref;
+
+/**
+ * @brief Suffix counts, one entry per state (kept in step with `state`).
+ * * `cnt_suf[u]` is the number of input strings that end with the strings of state `u`,
+ * i.e. whose end state lies in the suffix-link subtree of `u`. The batch solver fills it
+ * once by propagation; the online engine keeps it current after every insertion. A clone
+ * takes over the subtree of the state it splits, so it starts with that state's count.
+ */
+std::vector<int> cnt_suf;
+
+/**
+ * @brief Flat transition storage shared by all states.
+ * * Instead of a `std::map` per state, every state owns a contiguous slice
+ * `[edge_begin, edge_begin + edge_cnt)` of two parallel arrays. A state has at most
+ * one edge per distinct character, and in practice only a handful, so a linear scan of
+ * its slice touches one or two cache lines. When a slice is full it is moved to the end
+ * of the pool with twice the capacity; the abandoned slots are never reused, which at
+ * most doubles the pool and keeps every operation allocation-free in the common case.
+ */
+std::vector<char> edge_char;
+std::vector<int> edge_to;
+
+/**
+ * @brief Returns the transition of state `u` on character `c`, or -1 if there is none.
+ */
+inline int gsa_next(int u, char c) {
+    const Node& node = state[u];
+    for (int e = node.edge_begin, end = e + node.edge_cnt; e < end; ++e) {
+        if (edge_char[e] == c) return edge_to[e];
+    }
+    return -1;
+}
+
+/**
+ * @brief Reserves a fresh slice of `cap` edges at the end of the pool for state `u`.
+ */
+inline void gsa_alloc_edges(int u, int cap) {
+    state[u].edge_begin = (int)edge_char.size();
+    state[u].edge_cap = cap;
+    edge_char.resize(edge_char.size() + cap);
+    edge_to.resize(edge_to.size() + cap);
+}
+
+/**
+ * @brief Sets the transition of state `u` on character `c` to `v`, adding the edge if needed.
+ */
+inline void gsa_set_next(int u, char c, int v) {
+    Node& node = state[u];
+    for (int e = node.edge_begin, end = e + node.edge_cnt; e < end; ++e) {
+        if (edge_char[e] == c) {
+            edge_to[e] = v;
+            return;
+        }
+    }
+    if (node.edge_cnt == node.edge_cap) {
+        int old_begin = node.edge_begin;
+        gsa_alloc_edges(u, node.edge_cap == 0 ? 2 : 2 * node.edge_cap);
+        std::copy_n(edge_char.begin() + old_begin, node.edge_cnt, edge_char.begin() + node.edge_begin);
+        std::copy_n(edge_to.begin() + old_begin, node.edge_cnt, edge_to.begin() + node.edge_begin);
+    }
+    edge_char[node.edge_begin + node.edge_cnt] = c;
+    edge_to[node.edge_begin + node.edge_cnt] = v;
+    node.edge_cnt++;
+}
+
+/**
+ * @brief Copies all transitions of state `src` into the (edgeless) state `dst`.
+ */
+inline void gsa_copy_edges(int dst, int src) {
+    int cnt = state[src].edge_cnt;
+    gsa_alloc_edges(dst, cnt == 0 ? 2 : cnt);
+    std::copy_n(edge_char.begin() + state[src].edge_begin, cnt, edge_char.begin() + state[dst].edge_begin);
+    std::copy_n(edge_to.begin() + state[src].edge_begin, cnt, edge_to.begin() + state[dst].edge_begin);
+    state[dst].edge_cnt = cnt;
+}
+
+/**
+ * @brief Appends a new edgeless state to the arena and returns its index.
+ */
+inline int gsa_new_state(int len, int link) {
+    state.push_back({len, link, 0, 0, 0});
+    cnt_pref.push_back(0);
+    cnt_suf.push_back(0);
+    return sz++;
+}
+
+/**
+ * @brief Grows `v` to hold at least `extra` more elements, at least doubling its capacity.
+ */
+template <typename T>
+void reserve_extra(std::vector<T>& v, size_t extra) {
+    if (v.size() + extra > v.capacity()) {
+        v.reserve(std::max(v.size() + extra, 2 * v.capacity()));
+    }
+}
+
+/**
+ * @brief Makes room in the arena and edge pool for inserting `len` more characters.
+ * * A suffix automaton gains at most 2 states and 3 transitions per character.
+ * * @param len The number of characters about to be inserted.
+ */
+void gsa_reserve(size_t len) {
+    reserve_extra(state, 2 * len);
+    reserve_extra(cnt_pref, 2 * len);
+    reserve_extra(cnt_suf, 2 * len);
+    reserve_extra(edge_char, 3 * len);
+    reserve_extra(edge_to, 3 * len);
+}
+
 /**
  * @brief Initializes the Generalized Suffix Automaton.
  * * Sets up the initial state of the automaton with a single root state
- * representing an empty string. All other states are effectively uninitialized.
+ * representing an empty string. All other storage is reserved per string.
  */
 void gsa_init() {
-    state[0].len = 0;
-    state[0].link = -1;
-    sz = 1;
+    state.clear();
+    cnt_pref.clear();
+    cnt_suf.clear();
+    edge_char.clear();
+    edge_to.clear();
+    sz = 0;
+    gsa_new_state(0, -1);
     last = 0;
 }
 
@@ -93,33 +243,56 @@ void gsa_init() {
  * to the string currently represented by the `last` state. It handles the creation
  * of new states and the update of suffix links, including the "cloning" process
  * to maintain the automaton's properties.
+ * * Every string is inserted starting from `last = 0`, so the automaton is generalized
+ * without separator characters. When the transition on `c` already exists (the current
+ * prefix was seen in an earlier string) no new state is created: we either reuse the
+ * target directly or split it with a clone, exactly as in the ordinary clone step.
  * * @param c The character to be added to the automaton.
  */
 void gsa_extend(char c) {
-    int cur = sz++;
-    state[cur].len = state[last].len + 1;
+    int q = gsa_next(last, c);
+    if (q != -1) {
+        if (state[q].len == state[last].len + 1) {
+            // The extended string is already the longest string of state q
+            last = q;
+        } else {
+            // It is a shorter string of q, so it gets its own clone
+            int clone = gsa_new_state(state[last].len + 1, state[q].link);
+            gsa_copy_edges(clone, q);
+            cnt_suf[clone] = cnt_suf[q];
+            int p = last;
+            while (p != -1 && gsa_next(p, c) == q) {
+                gsa_set_next(p, c, clone);
+                p = state[p].link;
+            }
+            state[q].link = clone;
+            last = clone;
+        }
+        return;
+    }
+
+    int cur = gsa_new_state(state[last].len + 1, 0);
     int p = last;
     // Traverse suffix links from the last state to find a path for 'c'
-    while (p != -1 && state[p].next.find(c) == state[p].next.end()) {
-        state[p].next[c] = cur;
+    while (p != -1 && gsa_next(p, c) == -1) {
+        gsa_set_next(p, c, cur);
         p = state[p].link;
     }
     if (p == -1) {
         // No path for 'c' found, link to root
         state[cur].link = 0;
     } else {
-        int q = state[p].next[c];
+        q = gsa_next(p, c);
         if (state[q].len == state[p].len + 1) {
             // Path found and is of the correct length, simple link
             state[cur].link = q;
         } else {
             // Path found but needs a "cloned" state to maintain properties
-            int clone = sz++;
-            state[clone].len = state[p].len + 1;
-            state[clone].next = state[q].next;
-            state[clone].link = state[q].link;
-            while (p != -1 && state[p].next[c] == q) {
-                state[p].next[c] = clone;
+            int clone = gsa_new_state(state[p].len + 1, state[q].link);
+            gsa_copy_edges(clone, q);
+            cnt_suf[clone] = cnt_suf[q];
+            while (p != -1 && gsa_next(p, c) == q) {
+                gsa_set_next(p, c, clone);
                 p = state[p].link;
             }
             state[q].link = clone;
@@ -129,6 +302,80 @@ void gsa_extend(char c) {
     last = cur;
 }
 
+/**
+ * @brief Inserts a whole string into the GSA and records its prefix weights.
+ * * The string is added from the root one character at a time. Alongside, the KMP prefix
+ * function gives the longest proper border of every prefix, and each prefix $p$ adds
+ * $|p| - \text{border}(p)$ to `cnt_pref` of the state it lands in. The string can be
+ * discarded afterwards; no second pass over the input is needed.
+ * * @param s The string to insert.
+ * @param border Scratch buffer for the prefix function, reused between calls.
+ * @param prefix_states If given, receives the state of every prefix of `s`.
+ * @return The state whose longest string is `s` (its end state).
+ */
+int gsa_add_string(const std::string& s, std::vector<int>& border, std::vector<int>* prefix_states = nullptr) {
+    gsa_reserve(s.size());
+    border.assign(s.size(), 0);
+    if (prefix_states) prefix_states->resize(s.size());
+    last = 0;
+    for (size_t j = 0; j < s.size(); ++j) {
+        if (j > 0) {
+            int k = border[j - 1];
+            while (k > 0 && s[j] != s[k]) k = border[k - 1];
+            border[j] = (s[j] == s[k]) ? k + 1 : 0;
+        }
+        gsa_extend(s[j]);
+        cnt_pref[last] += (int)(j + 1) - border[j];
+        if (prefix_states) (*prefix_states)[j] = last;
+    }
+    return last;
+}
+
+/**
+ * @brief Orders the states of the GSA by increasing `len` with a counting sort.
+ * * Suffix links always point to a strictly shorter state, so walking this order
+ * backwards visits every state before its suffix link. `len` is bounded by the
+ * longest input string, which makes this O(states + max_len) with two flat arrays.
+ * * @return The state indices sorted by `len`.
+ */
+std::vector<int> gsa_states_by_len() {
+    int max_len = 0;
+    for (int u = 0; u < sz; ++u) {
+        max_len = std::max(max_len, state[u].len);
+    }
+    std::vector<int> bucket(max_len + 1, 0);
+    for (int u = 0; u < sz; ++u) {
+        bucket[state[u].len]++;
+    }
+    for (int l = 1; l <= max_len; ++l) {
+        bucket[l] += bucket[l - 1];
+    }
+    std::vector<int> order(sz);
+    for (int u = sz - 1; u >= 0; --u) {
+        order[--bucket[state[u].len]] = u;
+    }
+    return order;
+}
+
+/**
+ * @brief Unsigned 128-bit accumulator for lazily reduced sums.
+ * * A product of two non-negative `int`s is below $2^{62}$, so $2^{66}$ such terms fit before
+ * overflow: sums over all states can be accumulated exactly and reduced once at the end.
+ */
+using u128 = unsigned __int128;
+
+/**
+ * @brief Reduces a lazily accumulated sum modulo `MOD`.
+ * * `acc % MOD` on a 128-bit value would call the generic `__umodti3` division routine, so
+ * the two 64-bit halves are reduced separately, as $hi \cdot 2^{64} + lo$, with 64-bit `%`
+ * only.
+ */
+inline long long reduce_mod(u128 acc) {
+    constexpr std::uint64_t TWO_64_MOD = (std::uint64_t)(((u128)1 << 64) % MOD);
+    std::uint64_t hi = (std::uint64_t)(acc >> 64) % MOD, lo = (std::uint64_t)acc % MOD;
+    return (long long)((hi * TWO_64_MOD + lo) % MOD);
+}
+
 /**
  * @brief Calculates modular exponentiation.
  * * Computes `(base^exp) % MOD` efficiently using binary exponentiation.
@@ -158,106 +405,759 @@ long long modInverse(long long n) {
     return power(n, MOD - 2);
 }
 
-int main() {
-    // Set up fast I/O
-    std::ios_base::sync_with_stdio(false);
-    std::cin.tie(NULL);
+/**
+ * @brief Running totals of the online engine.
+ * * `online_total` is $\sum_{k,l} F(s_k, s_l)$ over all ordered pairs of inserted strings
+ * (including $k=l$) and `online_diag` is $\sum_k F(s_k, s_k) = \sum_k |s_k|$, both modulo `MOD`.
+ */
+long long online_total = 0, online_diag = 0;
+int online_count = 0;
 
-    int n;
-    std::cin >> n;
-    std::vector<std::string> strings(n);
-    long long sum_lengths = 0;
-    // Read all strings and calculate their total length
-    for (int i = 0; i < n; ++i) {
-        std::cin >> strings[i];
-        sum_lengths += strings[i].length();
+/**
+ * @brief Adds one string to the corpus and updates the running totals.
+ * * Pairs between earlier strings are unaffected, so only the pairs involving the new
+ * string $s$ are added:
+ * - $\sum_k F(s_k, s)$: every prefix of $s$ contributes its weight times the number of
+ *   strings ending with it, i.e. `cnt_suf` of its state.
+ * - $\sum_l F(s, s_l)$: the suffix-link chain from the end state of $s$ holds exactly the
+ *   suffixes of $s$, so this is the sum of `cnt_pref` along the chain.
+ * Both sums include $F(s, s) = |s|$ once. The cost is $O(|s|)$ on top of the insertion.
+ * * @param s The string to add.
+ * @param border Scratch buffer for the prefix function.
+ * @param prefix_states Scratch buffer for the prefix states of `s`.
+ */
+void online_add_string(const std::string& s, std::vector<int>& border, std::vector<int>& prefix_states) {
+    int end = gsa_add_string(s, border, &prefix_states);
+    // s is now a suffix of one more string for every state on its suffix-link chain.
+    for (int u = end; u != -1; u = state[u].link) {
+        cnt_suf[u]++;
     }
 
+    u128 into_acc = 0;
+    for (size_t j = 0; j < s.size(); ++j) {
+        std::uint64_t weight = (j + 1) - border[j];
+        into_acc += weight * (std::uint64_t)cnt_suf[prefix_states[j]];
+    }
+    long long into_s = reduce_mod(into_acc);
+    long long from_s = 0;
+    for (int u = end; u > 0; u = state[u].link) {
+        from_s += cnt_pref[u];
+    }
+    from_s %= MOD;
+
+    long long len = (long long)s.size() % MOD;
+    online_total = ((online_total + into_s + from_s - len) % MOD + MOD) % MOD;
+    online_diag = (online_diag + len) % MOD;
+    online_count++;
+}
+
+/**
+ * @brief Expected chain cost of the strings inserted so far through `online_add_string()`.
+ */
+long long online_expected_cost() {
+    long long final_sum = (online_total - online_diag + MOD) % MOD;
+    return (final_sum * modInverse(online_count)) % MOD;
+}
+
+/**
+ * @brief Online mode: reports the expected cost after every inserted string.
+ * * Reads the usual input and then keeps reading further batches in the same format
+ * (a count followed by that many strings) until end of input.
+ */
+void run_online() {
     gsa_init();
-    std::vector<int> end_states(n);
-    std::vector<int> cnt_pref(MAX_STATES, 0);
+    std::string s;
+    std::vector<int> border, prefix_states;
+    int batch;
+    while (std::cin >> batch) {
+        for (int i = 0; i < batch && std::cin >> s; ++i) {
+            online_add_string(s, border, prefix_states);
+            std::cout << online_expected_cost() << '\n';
+        }
+    }
+}
+
+/**
+ * @brief Prefix states of every input string, in CSR form (pair query modes only).
+ * * The prefixes of string `i` of lengths $1, 2, \dots$ live in the states
+ * `prefix_state[prefix_begin[i]]`, `prefix_state[prefix_begin[i] + 1]`, ...
+ */
+std::vector<int> prefix_begin, prefix_state;
 
-    // Build the GSA for all strings.
-    // We add a unique separator between each string to ensure suffixes do not
-    // cross string boundaries in the automaton's structure.
+/**
+ * @brief Reads `end_states.size()` strings and inserts them into a fresh GSA.
+ * * Each string restarts from the root, so suffixes never cross string boundaries and
+ * no separator states are needed. Prefix weights are recorded during insertion, so only
+ * the current string is ever kept in memory.
+ * * @param end_states Receives the end state of every string.
+ * @param keep_prefixes Whether to fill `prefix_begin` / `prefix_state` for pair queries.
+ * @return The total length of the strings read.
+ */
+long long gsa_build(std::vector<int>& end_states, bool keep_prefixes) {
+    int n = (int)end_states.size();
+    long long sum_lengths = 0;
+    gsa_init();
+    prefix_begin.assign(1, 0);
+    prefix_state.clear();
+    std::string s;
+    std::vector<int> border, prefix_states;
     for (int i = 0; i < n; ++i) {
-        last = 0;
-        for (char c : strings[i]) {
-            gsa_extend(c);
+        std::cin >> s;
+        sum_lengths += s.length();
+        if (keep_prefixes) {
+            end_states[i] = gsa_add_string(s, border, &prefix_states);
+            prefix_state.insert(prefix_state.end(), prefix_states.begin(), prefix_states.end());
+            prefix_begin.push_back((int)prefix_state.size());
+        } else {
+            end_states[i] = gsa_add_string(s, border);
         }
-        end_states[i] = last;
-        if (i < n - 1) {
-             gsa_extend('Z' + 1 + i);
+    }
+    return sum_lengths;
+}
+
+/**
+ * @brief Fills `cnt_suf` from the end states of all strings.
+ * * A state represents a suffix of a string if the string ends at a state which has a
+ * suffix link path to it. We initialize counts for end-of-string states and propagate
+ * them up the suffix link tree, longest states first.
+ */
+void gsa_count_suffixes(const std::vector<int>& end_states) {
+    for (int e : end_states) {
+        cnt_suf[e]++;
+    }
+    std::vector<int> order = gsa_states_by_len();
+    for (int i = sz - 1; i > 0; --i) {
+        int u = order[i];
+        cnt_suf[state[u].link] += cnt_suf[u];
+    }
+}
+
+/**
+ * @brief Read-only view of a finished GSA and its per-string data.
+ * * The query functions below only read the automaton, so they work on this view, which
+ * points either into the live global arrays (`gsa_view()`) or into a memory-mapped
+ * snapshot (`snapshot_map()`), without copying either.
+ */
+struct GsaView {
+    int sz, n;
+    long long sum_lengths;
+    const Node* state;
+    const char* edge_char;
+    const int* edge_to;
+    const int* cnt_pref;
+    const int* cnt_suf;
+    const int* end_states;
+    const int* prefix_begin;
+    const int* prefix_state;
+};
+
+/**
+ * @brief Returns a view of the live automaton built by `gsa_build()`.
+ */
+GsaView gsa_view(const std::vector<int>& end_states, long long sum_lengths) {
+    return {sz, (int)end_states.size(), sum_lengths, state.data(), edge_char.data(), edge_to.data(),
+            cnt_pref.data(), cnt_suf.data(), end_states.data(), prefix_begin.data(), prefix_state.data()};
+}
+
+/**
+ * @brief Computes the sum of overlap lengths for all ordered pairs (including k=l).
+ * * The total sum is the sum of contributions from each state in the GSA.
+ * All substrings of state 'u' are suffixes of the same `cnt_suf[u]` strings, and
+ * `cnt_pref[u]` holds the weights of the prefixes that fall into 'u'.
+ * The products are summed exactly in 128 bits and reduced once, so the loop has
+ * no divisions at all.
+ * * @return $\sum_{k,l} F(s_k, s_l)$ modulo `MOD`.
+ */
+long long gsa_overlap_total(const GsaView& g) {
+    u128 total_sum = 0;
+    for (int u = 1; u < g.sz; ++u) {
+        std::uint64_t pref_weight = g.cnt_pref[u];
+        std::uint64_t suf_count = g.cnt_suf[u];
+        total_sum += pref_weight * suf_count;
+    }
+    return reduce_mod(total_sum);
+}
+
+/**
+ * @brief Computes the expected chain cost from the overlap total.
+ */
+long long gsa_expected_cost(const GsaView& g) {
+    long long total_sum = gsa_overlap_total(g);
+
+    // Subtract the F(s_k, s_k) part to get the sum for distinct pairs.
+    // A string is both a suffix and a prefix of itself, so F(s_k, s_k) = |s_k|.
+    long long diag_sum = g.sum_lengths % MOD;
+
+    // Compute the final sum for distinct pairs
+    long long final_sum = (total_sum - diag_sum + MOD) % MOD;
+
+    // Calculate the expected cost by dividing the final sum by n
+    return (final_sum * modInverse(g.n)) % MOD;
+}
+
+/**
+ * @brief Computes the entry and exit times of every state in the suffix-link tree.
+ * * State `v` lies on the suffix-link chain of `u` exactly when
+ * `tin[v] <= tin[u] && tin[u] <= tout[v]`.
+ */
+void gsa_euler_tour(const GsaView& g, std::vector<int>& tin, std::vector<int>& tout) {
+    // Children lists of the suffix-link tree in CSR form
+    std::vector<int> child_begin(g.sz + 1, 0), child(g.sz > 0 ? g.sz - 1 : 0);
+    for (int u = 1; u < g.sz; ++u) child_begin[g.state[u].link + 1]++;
+    for (int u = 0; u < g.sz; ++u) child_begin[u + 1] += child_begin[u];
+    std::vector<int> fill(child_begin.begin(), child_begin.end() - 1);
+    for (int u = 1; u < g.sz; ++u) child[fill[g.state[u].link]++] = u;
+
+    tin.assign(g.sz, 0);
+    tout.assign(g.sz, 0);
+    std::vector<int> stack = {0}, next_child(child_begin.begin(), child_begin.end() - 1);
+    int timer = 0;
+    tin[0] = timer++;
+    while (!stack.empty()) {
+        int u = stack.back();
+        if (next_child[u] < child_begin[u + 1]) {
+            int v = child[next_child[u]++];
+            tin[v] = timer++;
+            stack.push_back(v);
+        } else {
+            tout[u] = timer - 1;
+            stack.pop_back();
         }
     }
-    
-    // Count prefix occurrences for each state. A state is a prefix of a string
-    // if that string's path from the root goes through the state. We can count
-    // this by simply traversing each string on the automaton and incrementing a counter.
-    for (int i = 0; i < n; ++i) {
-        int curr = 0;
-        for (char c : strings[i]) {
-            curr = state[curr].next.at(c);
-            cnt_pref[curr]++;
+}
+
+/**
+ * @brief Answers a batch of overlap queries $F(s_k, s_l)$ offline.
+ * * $F(s_k, s_l)$ is the length of the longest prefix of $s_l$ whose state lies on the
+ * suffix-link chain of $s_k$'s end state. Queries are grouped by $l$; the prefix states of
+ * $s_l$ are tree intervals that are nested or disjoint, so one sweep over them (sorted by
+ * entry time) with a stack of open intervals answers all queries of that $l$, the top of
+ * the stack being the deepest, i.e. longest, prefix containing the query point. Each string
+ * is swept at most once, giving $O((\sum|s_i| + q) \log)$ overall instead of a prefix
+ * function per pair.
+ * * @param g The automaton, with prefix states.
+ * @param queries Pairs $(k, l)$ of 0-based string indices.
+ * @return $F(s_k, s_l)$ for every query, in input order.
+ */
+std::vector<int> gsa_pair_overlaps(const GsaView& g, const std::vector<std::pair<int, int>>& queries) {
+    int n = g.n;
+    int q = (int)queries.size();
+    std::vector<int> tin, tout;
+    gsa_euler_tour(g, tin, tout);
+
+    // Group the queries by l (counting sort), then by query point inside each group
+    std::vector<int> group_begin(n + 1, 0), by_l(q);
+    for (const auto& [k, l] : queries) group_begin[l + 1]++;
+    for (int l = 0; l < n; ++l) group_begin[l + 1] += group_begin[l];
+    std::vector<int> fill(group_begin.begin(), group_begin.end() - 1);
+    for (int i = 0; i < q; ++i) by_l[fill[queries[i].second]++] = i;
+
+    std::vector<int> answer(q, 0);
+    std::vector<int> marks, open;
+    for (int l = 0; l < n; ++l) {
+        int qb = group_begin[l], qe = group_begin[l + 1];
+        if (qb == qe) continue;
+        auto point = [&](int i) { return tin[g.end_states[queries[i].first]]; };
+        std::sort(by_l.begin() + qb, by_l.begin() + qe, [&](int a, int b) { return point(a) < point(b); });
+
+        // Prefix lengths of s_l, ordered by entry time (ancestors first)
+        marks.clear();
+        for (int j = g.prefix_begin[l]; j < g.prefix_begin[l + 1]; ++j) marks.push_back(j - g.prefix_begin[l]);
+        const int* ps = g.prefix_state + g.prefix_begin[l];
+        std::sort(marks.begin(), marks.end(), [&](int a, int b) { return tin[ps[a]] < tin[ps[b]]; });
+
+        open.clear();
+        size_t m = 0;
+        for (int t = qb; t < qe; ++t) {
+            int x = point(by_l[t]);
+            while (m < marks.size() && tin[ps[marks[m]]] <= x) {
+                while (!open.empty() && tout[ps[open.back()]] < tin[ps[marks[m]]]) open.pop_back();
+                open.push_back(marks[m++]);
+            }
+            while (!open.empty() && tout[ps[open.back()]] < x) open.pop_back();
+            answer[by_l[t]] = open.empty() ? 0 : open.back() + 1;
         }
     }
-    
-    // Count suffix occurrences for each state. A state represents a suffix of a string
-    // if the string ends at a state which has a suffix link path to the current state.
-    // We initialize counts for end-of-string states and propagate them up the suffix links.
-    std::vector<int> cnt_suf(sz, 0);
-    for (int i = 0; i < n; ++i) {
-        cnt_suf[end_states[i]]++;
+    return answer;
+}
+
+/**
+ * @brief Lists the strings with the largest overlap $F(s_k, s_l)$ for a fixed $k \ne l$.
+ * * The suffix-link chain of $s_k$'s end state visits the suffixes of $s_k$ from longest to
+ * shortest, so the first time a string $l$ shows up as the owner of a prefix state on the
+ * chain gives $F(s_k, s_l)$, and owners come out in decreasing overlap order.
+ * * @param k The 0-based index of the left string.
+ * @param count The maximum number of strings to report.
+ * @param owner_begin, owner Strings owning a prefix in each state, in CSR form.
+ * @param seen Scratch array of size n, holding the stamp of the last query that saw each string.
+ * @return Pairs (l, F(s_k, s_l)) with positive overlap, best first.
+ */
+std::vector<std::pair<int, int>> gsa_top_overlaps(const GsaView& g, int k, int count,
+                                                  const std::vector<int>& owner_begin, const std::vector<int>& owner,
+                                                  std::vector<int>& seen) {
+    std::vector<std::pair<int, int>> best;
+    for (int u = g.end_states[k]; u > 0 && (int)best.size() < count; u = g.state[u].link) {
+        for (int i = owner_begin[u]; i < owner_begin[u + 1] && (int)best.size() < count; ++i) {
+            int l = owner[i];
+            if (l == k || seen[l] == k + 1) continue;
+            seen[l] = k + 1;
+            best.push_back({l, g.state[u].len});
+        }
+    }
+    for (const auto& [l, f] : best) seen[l] = 0;
+    return best;
+}
+
+/**
+ * @brief Pair query mode: reads $q$ pairs $(k, l)$ and prints $F(s_k, s_l)$ for each.
+ */
+void run_pair_queries(const GsaView& g) {
+    int q;
+    std::cin >> q;
+    std::vector<std::pair<int, int>> queries(q);
+    for (auto& [k, l] : queries) {
+        std::cin >> k >> l;
+        --k, --l;
+    }
+    for (int f : gsa_pair_overlaps(g, queries)) {
+        std::cout << f << '\n';
     }
-    
-    // Sort states by length in descending order to correctly propagate counts
-    // up the suffix link tree.
-    std::vector<std::pair<int, int>> sorted_states(sz);
-    for (int i = 0; i < sz; ++i) {
-        sorted_states[i] = {state[i].len, i};
+}
+
+/**
+ * @brief Top-k mode: reads $q$ pairs $(k, t)$ and prints the $t$ best partners of $s_k$.
+ * * Each answer line lists up to $t$ entries `l:F` (1-based $l$), by decreasing overlap.
+ */
+void run_top_queries(const GsaView& g) {
+    int n = g.n;
+    int total_prefixes = g.prefix_begin[n];
+    // Invert prefix_state: for every state, the strings that have a prefix there
+    std::vector<int> owner_begin(g.sz + 1, 0), owner(total_prefixes);
+    for (int j = 0; j < total_prefixes; ++j) owner_begin[g.prefix_state[j] + 1]++;
+    for (int u = 0; u < g.sz; ++u) owner_begin[u + 1] += owner_begin[u];
+    std::vector<int> fill(owner_begin.begin(), owner_begin.end() - 1);
+    for (int l = 0; l < n; ++l) {
+        for (int j = g.prefix_begin[l]; j < g.prefix_begin[l + 1]; ++j) owner[fill[g.prefix_state[j]]++] = l;
     }
-    std::sort(sorted_states.rbegin(), sorted_states.rend());
 
-    for (const auto& p : sorted_states) {
-        int u = p.second;
-        if (state[u].link != -1) {
-            cnt_suf[state[u].link] += cnt_suf[u];
+    std::vector<int> seen(n, 0);
+    int q;
+    std::cin >> q;
+    for (int i = 0; i < q; ++i) {
+        int k, t;
+        std::cin >> k >> t;
+        auto best = gsa_top_overlaps(g, k - 1, t, owner_begin, owner, seen);
+        for (size_t j = 0; j < best.size(); ++j) {
+            std::cout << (j ? " " : "") << best[j].first + 1 << ':' << best[j].second;
         }
+        std::cout << '\n';
     }
+}
 
-    // Calculate the total sum of overlap lengths for all ordered pairs (including k=l).
-    // The total sum is the sum of contributions from each state in the GSA.
-    // The number of substrings represented by state 'u' is len(u) - len(link(u)).
-    // Each of these substrings appears as a prefix `cnt_pref[u]` times and as a suffix
-    // `cnt_suf[u]` times.
-    long long total_sum = 0;
-    for (int u = 1; u < sz; ++u) {
-        long long len_diff = state[u].len - state[state[u].link].len;
-        long long pref_count = cnt_pref[u];
-        long long suf_count = cnt_suf[u];
-        long long term = (len_diff * pref_count) % MOD;
-        term = (term * suf_count) % MOD;
-        total_sum = (total_sum + term) % MOD;
-    }
-    
-    // Subtract the F(s_k, s_k) part to get the sum for distinct pairs.
-    // F(s_k, s_k) is the length of the longest proper suffix of s_k that is also a prefix.
-    // This length is given by the length of the longest suffix link from s_k's end state.
-    long long diag_sum = 0;
+/**
+ * @brief Header of an automaton snapshot file.
+ * * The file is the header followed by the raw arrays of a `GsaView`, each starting at an
+ * 8-byte aligned offset so it can be used in place once mapped. The arrays are written in
+ * the native layout of `Node` and `int`, so a snapshot is only valid on the platform (and
+ * build) that wrote it; `magic` and the recorded `sizeof(Node)` guard against misuse.
+ */
+struct SnapshotHeader {
+    char magic[8];
+    std::int64_t node_size;
+    std::int64_t states, edges, strings, prefixes, sum_lengths;
+    std::int64_t off_state, off_edge_char, off_edge_to, off_cnt_pref, off_cnt_suf;
+    std::int64_t off_end_states, off_prefix_begin, off_prefix_state, file_size;
+};
+
+const char SNAPSHOT_MAGIC[8] = {'G', 'S', 'A', 'S', 'N', 'A', 'P', '1'};
+
+/**
+ * @brief Writes the automaton behind `g` to `path` as a snapshot.
+ * * The edge pool is compacted on the way out: every state's edges are written back to
+ * back with `edge_cap == edge_cnt`, dropping the slots abandoned by relocations.
+ * * @return `true` on success.
+ */
+bool snapshot_save(const GsaView& g, const char* path) {
+    std::vector<Node> nodes(g.state, g.state + g.sz);
+    std::vector<char> chars;
+    std::vector<int> targets;
+    for (Node& node : nodes) {
+        int begin = (int)chars.size();
+        chars.insert(chars.end(), g.edge_char + node.edge_begin, g.edge_char + node.edge_begin + node.edge_cnt);
+        targets.insert(targets.end(), g.edge_to + node.edge_begin, g.edge_to + node.edge_begin + node.edge_cnt);
+        node.edge_begin = begin;
+        node.edge_cap = node.edge_cnt;
+    }
+
+    SnapshotHeader h = {};
+    std::copy_n(SNAPSHOT_MAGIC, 8, h.magic);
+    h.node_size = sizeof(Node);
+    h.states = g.sz;
+    h.edges = (std::int64_t)chars.size();
+    h.strings = g.n;
+    h.prefixes = g.prefix_begin[g.n];
+    h.sum_lengths = g.sum_lengths;
+
+    std::vector<std::pair<const void*, std::int64_t>> sections = {
+        {nodes.data(), h.states * (std::int64_t)sizeof(Node)},
+        {chars.data(), h.edges},
+        {targets.data(), h.edges * 4},
+        {g.cnt_pref, h.states * 4},
+        {g.cnt_suf, h.states * 4},
+        {g.end_states, h.strings * 4},
+        {g.prefix_begin, (h.strings + 1) * 4},
+        {g.prefix_state, h.prefixes * 4},
+    };
+    std::int64_t* offsets[] = {&h.off_state, &h.off_edge_char, &h.off_edge_to, &h.off_cnt_pref,
+                               &h.off_cnt_suf, &h.off_end_states, &h.off_prefix_begin, &h.off_prefix_state};
+    std::int64_t pos = sizeof(SnapshotHeader);
+    for (size_t i = 0; i < sections.size(); ++i) {
+        pos = (pos + 7) & ~7LL;
+        *offsets[i] = pos;
+        pos += sections[i].second;
+    }
+    h.file_size = pos;
+
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+    static const char zeros[8] = {};
+    pos = sizeof(SnapshotHeader);
+    for (size_t i = 0; i < sections.size() && ok; ++i) {
+        ok = std::fwrite(zeros, 1, *offsets[i] - pos, f) == (size_t)(*offsets[i] - pos);
+        if (ok && sections[i].second > 0) {
+            ok = std::fwrite(sections[i].first, 1, sections[i].second, f) == (size_t)sections[i].second;
+        }
+        pos = *offsets[i] + sections[i].second;
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+/**
+ * @brief Maps a snapshot written by `snapshot_save()` read-only and returns a view of it.
+ * * Nothing is copied or rebuilt: the view points straight into the mapping, so pages are
+ * loaded on first touch and shared through the page cache by every process mapping the
+ * same file. The mapping lives until the process exits.
+ * * @param g Receives the view.
+ * @return `true` if the file exists and looks like a valid snapshot.
+ */
+bool snapshot_map(const char* path, GsaView& g) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SnapshotHeader)) {
+        close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+
+    const char* data = static_cast<const char*>(base);
+    const SnapshotHeader& h = *reinterpret_cast<const SnapshotHeader*>(data);
+    if (!std::equal(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + 8, h.magic) || h.node_size != (std::int64_t)sizeof(Node) ||
+        h.file_size != (std::int64_t)st.st_size) {
+        munmap(base, st.st_size);
+        return false;
+    }
+    g.sz = (int)h.states;
+    g.n = (int)h.strings;
+    g.sum_lengths = h.sum_lengths;
+    g.state = reinterpret_cast<const Node*>(data + h.off_state);
+    g.edge_char = data + h.off_edge_char;
+    g.edge_to = reinterpret_cast<const int*>(data + h.off_edge_to);
+    g.cnt_pref = reinterpret_cast<const int*>(data + h.off_cnt_pref);
+    g.cnt_suf = reinterpret_cast<const int*>(data + h.off_cnt_suf);
+    g.end_states = reinterpret_cast<const int*>(data + h.off_end_states);
+    g.prefix_begin = reinterpret_cast<const int*>(data + h.off_prefix_begin);
+    g.prefix_state = reinterpret_cast<const int*>(data + h.off_prefix_state);
+    return true;
+}
+
+/**
+ * @brief Runs the query mode named by `mode` (or prints the expected cost) on `g`.
+ */
+void serve(const GsaView& g, const std::string& mode) {
+    if (mode == "--pairs") {
+        run_pair_queries(g);
+    } else if (mode == "--top") {
+        run_top_queries(g);
+    } else {
+        std::cout << gsa_expected_cost(g) << std::endl;
+    }
+}
+
+/**
+ * @brief Runs `fn(begin, end)` over `[0, count)` split into one chunk per hardware thread.
+ */
+template <typename Fn>
+void parallel_for(int count, Fn fn) {
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, count));
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(fn, (int)((long long)count * t / threads), (int)((long long)count * (t + 1) / threads));
+    }
+    fn(0, (int)((long long)count / threads));
+    for (auto& w : workers) w.join();
+}
+
+/**
+ * @brief Builds the suffix array of `s` with SA-IS (induced sorting) in $O(|s| + \text{upper})$.
+ * * @param s The text, with every value in `[0, upper]`.
+ * @param upper The largest value that may occur in `s`.
+ * @return The starting positions of the suffixes of `s` in lexicographic order.
+ */
+std::vector<int> sa_is(const std::vector<int>& s, int upper) {
+    int n = (int)s.size();
+    if (n == 0) return {};
+    if (n == 1) return {0};
+    if (n == 2) return s[0] < s[1] ? std::vector<int>{0, 1} : std::vector<int>{1, 0};
+
+    // ls[i]: suffix i is S-type (smaller than suffix i + 1)
+    std::vector<int> sa(n);
+    std::vector<bool> ls(n, false);
+    for (int i = n - 2; i >= 0; --i) {
+        ls[i] = (s[i] == s[i + 1]) ? ls[i + 1] : (s[i] < s[i + 1]);
+    }
+    // Bucket boundaries: sum_l[c] is the start of bucket c, sum_s[c] the start of its S part
+    std::vector<int> sum_l(upper + 1, 0), sum_s(upper + 1, 0);
     for (int i = 0; i < n; ++i) {
-        int end_state_idx = end_states[i];
-        if (state[end_state_idx].link != -1) {
-            diag_sum = (diag_sum + state[state[end_state_idx].link].len) % MOD;
+        if (!ls[i]) sum_s[s[i]]++;
+        else sum_l[s[i] + 1]++;
+    }
+    for (int c = 0; c <= upper; ++c) {
+        sum_s[c] += sum_l[c];
+        if (c < upper) sum_l[c + 1] += sum_s[c];
+    }
+
+    std::vector<int> buf(upper + 1);
+    auto induce = [&](const std::vector<int>& lms) {
+        std::fill(sa.begin(), sa.end(), -1);
+        std::copy(sum_s.begin(), sum_s.end(), buf.begin());
+        for (int d : lms) {
+            if (d == n) continue;
+            sa[buf[s[d]]++] = d;
+        }
+        std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+        sa[buf[s[n - 1]]++] = n - 1;
+        for (int i = 0; i < n; ++i) {
+            int v = sa[i];
+            if (v >= 1 && !ls[v - 1]) sa[buf[s[v - 1]]++] = v - 1;
+        }
+        std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+        for (int i = n - 1; i >= 0; --i) {
+            int v = sa[i];
+            if (v >= 1 && ls[v - 1]) sa[--buf[s[v - 1] + 1]] = v - 1;
+        }
+    };
+
+    // Sort the LMS suffixes by their LMS substrings, then recurse on the reduced string
+    std::vector<int> lms_map(n + 1, -1), lms;
+    for (int i = 1; i < n; ++i) {
+        if (!ls[i - 1] && ls[i]) {
+            lms_map[i] = (int)lms.size();
+            lms.push_back(i);
         }
     }
-    
-    // Compute the final sum for distinct pairs
-    long long final_sum = (total_sum - diag_sum + MOD) % MOD;
-    
-    // Calculate the expected cost by dividing the final sum by n
-    long long expected_cost = (final_sum * modInverse(n)) % MOD;
+    int m = (int)lms.size();
+    induce(lms);
+
+    if (m) {
+        std::vector<int> sorted_lms;
+        sorted_lms.reserve(m);
+        for (int v : sa) {
+            if (lms_map[v] != -1) sorted_lms.push_back(v);
+        }
+        std::vector<int> rec_s(m);
+        int rec_upper = 0;
+        rec_s[lms_map[sorted_lms[0]]] = 0;
+        for (int i = 1; i < m; ++i) {
+            int l = sorted_lms[i - 1], r = sorted_lms[i];
+            int end_l = (lms_map[l] + 1 < m) ? lms[lms_map[l] + 1] : n;
+            int end_r = (lms_map[r] + 1 < m) ? lms[lms_map[r] + 1] : n;
+            bool same = true;
+            if (end_l - l != end_r - r) {
+                same = false;
+            } else {
+                while (l < end_l && s[l] == s[r]) {
+                    ++l, ++r;
+                }
+                if (l == n || s[l] != s[r]) same = false;
+            }
+            if (!same) rec_upper++;
+            rec_s[lms_map[sorted_lms[i]]] = rec_upper;
+        }
+        std::vector<int> rec_sa = sa_is(rec_s, rec_upper);
+        for (int i = 0; i < m; ++i) {
+            sorted_lms[i] = lms[rec_sa[i]];
+        }
+        induce(sorted_lms);
+    }
+    return sa;
+}
+
+/**
+ * @brief Computes the expected cost with a suffix array instead of the GSA.
+ * * The strings are concatenated as $T = s_1 \# s_2 \# \dots s_n \#$ with a separator smaller
+ * than every character. For a position $i$ inside $s_k$ with $r$ characters left before the
+ * next separator, the suffix of $s_k$ of length $r$ is $v = T[i, i + r)$. The strings having
+ * $v$ as a prefix are exactly the string starts in the maximal SA range around `rank[i]`
+ * whose LCPs are all at least $r$ (a shorter string would hit `#` first). Each such string
+ * contributes $w(v) = r - \text{border}(v)$ exactly as in the GSA formula, and the border is
+ * read from the prefix function of any one of them. The ranges come from two monotonic-stack
+ * sweeps over the LCP array with a binary search per position, so everything is
+ * $O(L \log L)$ time and $O(L)$ memory, with no per-state transition tables.
+ * * The prefix functions, both range sweeps and the final summation run in parallel; SA-IS
+ * and the LCP array (Kasai) are sequential.
+ * * @param strings The input strings.
+ * @return The expected cost modulo `MOD`.
+ */
+long long sa_expected_cost(const std::vector<std::string>& strings) {
+    int n = (int)strings.size();
+    std::vector<int> text, start(n);
+    long long sum_lengths = 0;
+    for (int k = 0; k < n; ++k) {
+        start[k] = (int)text.size();
+        for (char c : strings[k]) text.push_back((unsigned char)c + 1);
+        text.push_back(0);
+        sum_lengths += strings[k].size();
+    }
+    int len = (int)text.size();
 
-    std::cout << expected_cost << std::endl;
+    // Prefix function of every string, stored at the string's positions in T
+    std::vector<int> border(len, 0);
+    parallel_for(n, [&](int kb, int ke) {
+        for (int k = kb; k < ke; ++k) {
+            const std::string& s = strings[k];
+            int* pi = border.data() + start[k];
+            for (int j = 1; j < (int)s.size(); ++j) {
+                int b = pi[j - 1];
+                while (b > 0 && s[j] != s[b]) b = pi[b - 1];
+                pi[j] = (s[j] == s[b]) ? b + 1 : 0;
+            }
+        }
+    });
+
+    std::vector<int> sa = sa_is(text, 256);
+    std::vector<int> rank(len);
+    for (int p = 0; p < len; ++p) rank[sa[p]] = p;
+
+    // lcp[p] = LCP(sa[p - 1], sa[p]) (Kasai), with -1 sentinels at both ends
+    std::vector<int> lcp(len + 1, -1);
+    for (int i = 0, h = 0; i < len; ++i) {
+        if (rank[i] == 0) {
+            h = 0;
+            continue;
+        }
+        int j = sa[rank[i] - 1];
+        while (i + h < len && j + h < len && text[i + h] == text[j + h]) h++;
+        lcp[rank[i]] = h;
+        if (h > 0) h--;
+    }
+
+    // rem[p]: characters left before the separator for the suffix of rank p
+    std::vector<int> rem(len);
+    for (int k = 0; k < n; ++k) {
+        int m = (int)strings[k].size();
+        for (int j = 0; j <= m; ++j) rem[rank[start[k] + j]] = m - j;
+    }
+
+    // Maximal range [lo[p], hi[p]] around p with all LCPs >= rem[p]
+    std::vector<int> lo(len), hi(len);
+    auto sweep_left = [&]() {
+        std::vector<int> stack;
+        for (int p = 0; p < len; ++p) {
+            while (!stack.empty() && lcp[stack.back()] >= lcp[p]) stack.pop_back();
+            stack.push_back(p);
+            // Topmost (nearest) index with lcp < rem[p]; the stack is increasing in lcp
+            auto it = std::partition_point(stack.begin(), stack.end(), [&](int j) { return lcp[j] < rem[p]; });
+            lo[p] = *(it - 1);
+        }
+    };
+    auto sweep_right = [&]() {
+        std::vector<int> stack = {len};
+        for (int p = len - 1; p >= 0; --p) {
+            auto it = std::partition_point(stack.begin(), stack.end(), [&](int j) { return lcp[j] < rem[p]; });
+            hi[p] = *(it - 1) - 1;
+            while (!stack.empty() && lcp[stack.back()] >= lcp[p]) stack.pop_back();
+            stack.push_back(p);
+        }
+    };
+    std::thread right_worker(sweep_right);
+    sweep_left();
+    right_worker.join();
+
+    // String starts by rank: prefix counts and the next start at or after each rank
+    std::vector<int> starts_before(len + 1, 0), next_start(len + 1, len);
+    std::vector<char> is_start(len, 0);
+    for (int k = 0; k < n; ++k) is_start[rank[start[k]]] = 1;
+    for (int p = 0; p < len; ++p) starts_before[p + 1] = starts_before[p] + is_start[p];
+    for (int p = len - 1; p >= 0; --p) next_start[p] = is_start[p] ? p : next_start[p + 1];
+
+    std::atomic<long long> partial_sum{0};
+    parallel_for(len, [&](int pb, int pe) {
+        u128 acc = 0;
+        for (int p = pb; p < pe; ++p) {
+            int r = rem[p];
+            if (r == 0) continue;
+            int count = starts_before[hi[p] + 1] - starts_before[lo[p]];
+            if (count == 0) continue;
+            int owner = sa[next_start[lo[p]]];
+            acc += (std::uint64_t)count * (std::uint64_t)(r - border[owner + r - 1]);
+        }
+        partial_sum += reduce_mod(acc);
+    });
+    long long total_sum = partial_sum % MOD;
+
+    long long final_sum = (total_sum - sum_lengths % MOD + MOD) % MOD;
+    return (final_sum * modInverse(n)) % MOD;
+}
+
+int main(int argc, char* argv[]) {
+    // Set up fast I/O
+    std::ios_base::sync_with_stdio(false);
+    std::cin.tie(NULL);
+
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--online") {
+        run_online();
+        return 0;
+    }
+    if (mode == "--sa") {
+        int n;
+        std::cin >> n;
+        std::vector<std::string> strings(n);
+        for (auto& str : strings) std::cin >> str;
+        std::cout << sa_expected_cost(strings) << std::endl;
+        return 0;
+    }
+    if (mode == "--load") {
+        GsaView g;
+        if (argc < 3 || !snapshot_map(argv[2], g)) {
+            std::cerr << "cannot load snapshot" << std::endl;
+            return 1;
+        }
+        serve(g, argc > 3 ? argv[3] : "");
+        return 0;
+    }
+
+    int n;
+    std::cin >> n;
+    std::vector<int> end_states(n);
+    bool keep_prefixes = mode == "--pairs" || mode == "--top" || mode == "--save";
+    long long sum_lengths = gsa_build(end_states, keep_prefixes);
+    gsa_count_suffixes(end_states);
+    GsaView g = gsa_view(end_states, sum_lengths);
+
+    if (mode == "--save") {
+        if (argc < 3 || !snapshot_save(g, argv[2])) {
+            std::cerr << "cannot write snapshot" << std::endl;
+            return 1;
+        }
+        mode = "";
+    }
+    serve(g, mode);
 
     return 0;
-}
\ No newline at end of file
+}
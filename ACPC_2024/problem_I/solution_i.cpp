@@ -1,8 +1,17 @@
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
 #include <queue>
-#include <tuple>
-#include <unordered_set>
+#include <string>
+#include <thread>
+#include <utility>
 
 /**
  * @file solution_i.cpp
@@ -17,7 +26,8 @@
  * tile into an adjacent hole. Adjacency includes all 8 directions (horizontal, vertical, and diagonal).
  * We need to find the minimum number of moves to accomplish this, or determine if it is impossible.
  * # Input
- * - The first line contains two integers $N$ and $M$ ($1 \le N, M \le 200$)
+ * - The first line contains two integers $N$ and $M$ ($1 \le N, M \le 200$; the plain BFS accepts
+ * larger boards, see below)
  * - The second line contains the initial coordinates of the target tile ($x_{target}, y_{target}$)
  * - The third line contains the initial coordinates of the hole ($x_{hole}, y_{hole}$)
  * - The fourth line contains an integer $Z$ ($0 \le Z \le (N \times M)/2$), the number of immovable tiles.
@@ -28,125 +38,872 @@
  * The problem is a classic shortest path problem on a state space graph, which can be solved
  * efficiently using a Breadth-First Search (BFS).
  * The state of the system is defined by the positions of the two key moving entities: the target tile
- * and the hole. A state can be represented by a tuple: `(target_x, target_y, hole_x, hole_y)`.
+ * and the hole. The grid is stored flat with a one-cell sentinel border, so a position is a single
+ * cell index and a state is packed into one integer: `target_cell * C + hole_cell`, where $C$ is the
+ * number of padded cells.
  * The BFS algorithm proceeds as follows:
- * 1.  A queue is initialized with the starting state, including the initial positions of the target
- * and the hole, and a move count of 0.
- * 2.  A `visited` set is used to store all states that have been explored. This is crucial for
- * preventing cycles and redundant computations, as the state space can be large. Since a simple
- * 2D array for visited states is not feasible, a hash-based data structure (like `std::unordered_set`)
- * is used with a custom hash function for the state tuple.
+ * 1.  A queue is initialized with the starting state. The search runs level by level, so the
+ * move count is the level number and does not need to be stored per state.
+ * 2.  A `visited` bitmap with one bit per packed state is used to store all states that have been
+ * explored. This is crucial for preventing cycles and redundant computations. Being indexed directly
+ * by the packed state, it needs no hashing and no allocations during the search, and the queue is a
+ * preallocated ring buffer of packed states. The bitmap has $C^2$ bits, capped at $2^{33}$ (1 GiB),
+ * which covers boards up to about $302 \times 302$; larger boards use an open-addressing hash set
+ * of packed states instead, whose memory follows the number of states actually visited.
  * 3.  The BFS explores possible moves level by level. From the current state, we consider sliding
  * any movable tile into the hole. A tile is movable if it is not an immovable tile and it is
- * in one of the 8 adjacent positions to the hole.
+ * in one of the 8 adjacent positions to the hole. Border cells are marked like immovable tiles,
+ * so this single lookup also replaces the bounds checks.
  * 4.  For each valid move, a new state is generated where the hole's position and the moved tile's
  * position are swapped. If the moved tile is the target tile, its position is updated in the
  * new state.
- * 5.  If a new state has not been visited, it is added to the queue with an incremented move count
- * and marked as visited.
- * 6.  The search continues until a state is reached where the target tile is at the destination
- * $(N, M)$. At this point, the number of moves for that state is the minimum possible, and the
- * program can terminate and output the result.
+ * 5.  If a new state has not been visited, it is marked as visited. If its target tile is at the
+ * destination $(N, M)$, the search stops at once and returns the current level number, which is the
+ * minimum number of moves (a start already at the destination gives 0). Otherwise the state is
+ * added to the queue, to be expanded with the next level; no move count is stored with it.
+ * 6.  Each level is the block of states that were in the queue when it started, so the search
+ * continues level by level until the goal is generated.
  * 7.  If the queue becomes empty and the target has not reached its destination, it means the goal
  * is unreachable, and the program outputs -1.
+ * # Modes
+ * - `--reduced` solves the same puzzle on a much smaller graph. Once the hole first touches the
+ * target, only its direction from the target matters, so a state is `(target, direction)`:
+ * $8NM$ states instead of $(NM)^2$. Sliding the target costs 1 move; moving the hole to another
+ * neighbour costs its BFS distance on the grid with the target cell blocked. These distances are
+ * computed on demand, once per `(target, direction)`, and Dijkstra runs over the reduced graph.
+ * - `--bidir` runs the BFS from the start state and from the goal states (target at $(N, M)$,
+ * hole on any free neighbour) at the same time, always expanding the smaller frontier by one
+ * level. Every move can be undone, so the backward search uses the same move generator.
+ * - `--astar` and `--ida` are goal-directed versions of the BFS. Let $c$ be the Chebyshev distance
+ * from the target to $(N, M)$ and $q$ the Chebyshev distance from the hole to the nearest neighbour
+ * of the target that is closer to $(N, M)$. The target needs at least $c$ moves that bring it
+ * closer, and each of them needs the hole on such a neighbour first: $q$ moves before the first
+ * one. Afterwards the hole sits on the cell the target left, at distance $c' + 1$ from $(N, M)$,
+ * and must reach distance $c' - 1$ before the next one, which takes at least 2 moves. This gives
+ * the lower bound $3c - 2 + q$. It changes by at most 1 per move, so it is consistent and A*
+ * never has to reopen a state. `--ida` replaces the visited set with a fixed transposition table
+ * of $2^{20}$ entries (about 16 MB) and re-expands states instead. It first runs `--reduced` to
+ * find out whether the goal is reachable, which already yields the answer and takes $O(NM)$
+ * memory, so `--ida` uses $O(NM)$ memory too and is only meant for comparing the searches.
+ * - `--moves` also prints the moves, one per line as `x y x' y'`: the tile at $(x, y)$ slides into
+ * the hole at $(x', y')$. The BFS keeps, next to the visited bitmap, 3 bits per state for the
+ * direction of the move that reached it, and the path is rebuilt backwards from the goal state.
+ * - `--parallel [threads]` is the same level-by-level BFS spread over several threads (all cores by
+ * default; build with `-pthread`). Each level is cut into chunks that the threads take in turn;
+ * every thread collects the states it discovers in its own next frontier, and the visited bitmap
+ * is updated with an atomic OR, so exactly one thread claims each new state. The threads are
+ * started once and synchronised by a barrier per level; levels with less than one chunk per thread
+ * are expanded by the main thread alone. The answer is the same as `bfs()`.
+ * - `--batch` answers many starts on the same board. After the usual input it reads an integer $Q$
+ * and $Q$ lines `x_target y_target x_hole y_hole`. One BFS from all goal states (moves are
+ * reversible) stores the distance of every reachable state in a table of 16-bit entries, and each
+ * start, including the one in the header, is then a single lookup. The table has $C^2$ entries,
+ * so this mode is meant for boards up to about $100 \times 100$.
+ * - `--stats`, given after the mode (or alone for the plain BFS), prints the number of states
+ * expanded to standard error.
  */
 
-// Custom hash function for the state tuple (target_x, target_y, hole_x, hole_y)
-// This is required for using std::unordered_set to store visited states.
-struct StateHash {
-    size_t operator()(const std::tuple<int, int, int, int>& state) const {
-        const int N = 201, M = 201; // Using max dimensions for hashing
-        const auto& [tx, ty, hx, hy] = state;
-        return ((size_t)tx * N * M * M) + ((size_t)ty * N * M) + ((size_t)hx * M) + hy;
-    }
-};
+/**
+ * @brief The board, stored as a flat grid padded with a one-cell sentinel border.
+ * * Cell $(x, y)$ with $0 \le x \le N + 1$, $0 \le y \le M + 1$ has index `x * W + y`. The
+ * border cells are `blocked` just like the immovable tiles, so a neighbour of any real cell
+ * is always a valid index and one lookup tells whether a tile can slide from it.
+ */
+int N, M;
+int W, C;                   // row stride (M + 2) and number of padded cells
+std::vector<char> blocked;  // border cells and immovable tiles
+int delta[8];               // index offsets of the 8 neighbours
+const int dx[] = {-1, -1, -1, 0, 0, 1, 1, 1};
+const int dy[] = {-1, 0, 1, -1, 1, -1, 0, 1};
+int goal;                   // cell (N, M)
+long long expanded = 0;     // states taken off the queue, reported by --stats
 
-int main() {
-    std::ios_base::sync_with_stdio(false);
-    std::cin.tie(NULL);
+using State = std::uint64_t;
 
-    int N, M;
-    std::cin >> N >> M;
+inline int cell(int x, int y) { return x * W + y; }
+inline State pack(int target, int hole) { return (State)target * C + hole; }
 
+/**
+ * @brief Reads the whole input and sets up the padded board.
+ * * @param target Receives the cell of the target tile.
+ * @param hole Receives the cell of the hole.
+ */
+void read_board(int& target, int& hole) {
+    std::cin >> N >> M;
     int xt, yt, xh, yh;
     std::cin >> xt >> yt >> xh >> yh;
 
+    W = M + 2;
+    C = (N + 2) * W;
+    blocked.assign(C, 0);
+    for (int x = 0; x <= N + 1; ++x) blocked[cell(x, 0)] = blocked[cell(x, M + 1)] = 1;
+    for (int y = 0; y <= M + 1; ++y) blocked[cell(0, y)] = blocked[cell(N + 1, y)] = 1;
+
     int Z;
     std::cin >> Z;
-
-    std::vector<std::vector<bool>> immovable_tiles(N + 1, std::vector<bool>(M + 1, false));
     for (int i = 0; i < Z; ++i) {
         int x, y;
         std::cin >> x >> y;
-        immovable_tiles[x][y] = true;
+        blocked[cell(x, y)] = 1;
     }
 
-    // A queue for the BFS. Each element stores the state and the number of moves.
-    // State: {target_x, target_y, hole_x, hole_y}
-    std::queue<std::tuple<int, int, int, int, int>> q;
-    
-    // A hash set to keep track of visited states to avoid cycles and redundant computations.
-    std::unordered_set<std::tuple<int, int, int, int>, StateHash> visited;
+    // The 8 possible directions for a tile to slide into the hole
+    for (int i = 0; i < 8; ++i) delta[i] = dx[i] * W + dy[i];
 
-    // Initial state
-    q.push({xt, yt, xh, yh, 0});
-    visited.insert({xt, yt, xh, yh});
+    goal = cell(N, M);
+    target = cell(xt, yt);
+    hole = cell(xh, yh);
+}
 
-    // The 8 possible directions for a tile to slide into the hole
-    int dx[] = {-1, -1, -1, 0, 0, 1, 1, 1};
-    int dy[] = {-1, 0, 1, -1, 1, -1, 0, 1};
+/**
+ * @brief One bit per packed state.
+ * * The bitmap is obtained with `calloc`, which for large sizes maps fresh zero pages
+ * instead of clearing them, so only the pages the search actually touches are paid for.
+ */
+struct VisitedBitmap {
+    std::uint64_t* bits;
+
+    explicit VisitedBitmap(State states) {
+        bits = static_cast<std::uint64_t*>(std::calloc(states / 64 + 1, sizeof(std::uint64_t)));
+        if (!bits) throw std::bad_alloc();
+    }
+    ~VisitedBitmap() { std::free(bits); }
+    VisitedBitmap(const VisitedBitmap&) = delete;
+    VisitedBitmap& operator=(const VisitedBitmap&) = delete;
+
+    bool test(State s) const { return bits[s >> 6] >> (s & 63) & 1; }
+
+    // Same as test_and_set, safe to call from several threads at once. Most states reached are
+    // already visited, so a plain load filters them out before the locked read-modify-write.
+    bool atomic_test_and_set(State s) {
+        std::uint64_t mask = std::uint64_t(1) << (s & 63);
+        std::uint64_t* word = &bits[s >> 6];
+        if (__atomic_load_n(word, __ATOMIC_RELAXED) & mask) return true;
+        return __atomic_fetch_or(word, mask, __ATOMIC_RELAXED) & mask;
+    }
+
+    // Marks s as visited and returns whether it already was
+    bool test_and_set(State s) {
+        std::uint64_t mask = std::uint64_t(1) << (s & 63);
+        std::uint64_t& word = bits[s >> 6];
+        bool was = word & mask;
+        word |= mask;
+        return was;
+    }
+};
+
+/**
+ * @brief Set of packed states for boards too large for `VisitedBitmap`.
+ * * Open addressing with linear probing in a power-of-two table, kept at most half full. State 0
+ * (target and hole both on the corner of the border) never occurs, so it marks an empty slot.
+ */
+struct FlatStateSet {
+    std::vector<State> slots;
+    size_t count = 0;
 
-    while (!q.empty()) {
-        auto [ctx, cty, chx, chy, moves] = q.front();
-        q.pop();
+    FlatStateSet() : slots(1 << 16, 0) {}
+
+    size_t slot(State s) const {
+        return (s * 0x9E3779B97F4A7C15ULL) >> 32 & (slots.size() - 1);
+    }
 
-        // Check if the target tile has reached the destination
-        if (ctx == N && cty == M) {
-            std::cout << moves << std::endl;
-            return 0;
+    bool test(State s) const {
+        for (size_t i = slot(s);; i = (i + 1) & (slots.size() - 1)) {
+            if (slots[i] == s) return true;
+            if (slots[i] == 0) return false;
         }
+    }
 
-        // Explore all 8 possible moves from the current hole position
-        for (int i = 0; i < 8; ++i) {
-            int ntx, nty, nhx, nhy;
-            int tile_x = chx + dx[i];
-            int tile_y = chy + dy[i];
-
-            // Check if the tile to be moved is within grid bounds
-            if (tile_x >= 1 && tile_x <= N && tile_y >= 1 && tile_y <= M) {
-                // Check if the tile is not an immovable tile
-                if (!immovable_tiles[tile_x][tile_y]) {
-                    // A valid tile can be moved into the hole.
-                    // The new hole position is the old tile position.
-                    nhx = tile_x;
-                    nhy = tile_y;
-                    
-                    // The new tile position is the old hole position.
-                    // Check if the moved tile is the target tile.
-                    if (tile_x == ctx && tile_y == cty) {
-                        ntx = chx;
-                        nty = chy;
-                    } else {
-                        ntx = ctx;
-                        nty = cty;
-                    }
-
-                    // Create the new state tuple
-                    std::tuple<int, int, int, int> new_state = {ntx, nty, nhx, nhy};
-
-                    // If the new state has not been visited, add it to the queue
-                    if (visited.find(new_state) == visited.end()) {
-                        visited.insert(new_state);
-                        q.push({ntx, nty, nhx, nhy, moves + 1});
-                    }
+    // Inserts s and returns whether it was already present
+    bool test_and_set(State s) {
+        size_t i = slot(s);
+        for (; slots[i] != 0; i = (i + 1) & (slots.size() - 1))
+            if (slots[i] == s) return true;
+        slots[i] = s;
+        if (++count * 2 > slots.size()) grow();
+        return false;
+    }
+
+    void grow() {
+        std::vector<State> old(slots.size() * 2, 0);
+        old.swap(slots);
+        for (State s : old) {
+            if (s == 0) continue;
+            size_t i = slot(s);
+            while (slots[i] != 0) i = (i + 1) & (slots.size() - 1);
+            slots[i] = s;
+        }
+    }
+};
+
+/**
+ * @brief FIFO of packed states in a power-of-two ring buffer.
+ * * The buffer is preallocated and only doubles (rarely) when the frontier outgrows it,
+ * so pushes and pops are plain array accesses.
+ */
+struct RingQueue {
+    std::vector<State> buf;
+    size_t head = 0, tail = 0;  // tail - head is the number of queued states
+
+    explicit RingQueue(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        buf.resize(cap);
+    }
+
+    bool empty() const { return head == tail; }
+    size_t size() const { return tail - head; }
+
+    void push(State s) {
+        if (tail - head == buf.size()) grow();
+        buf[tail++ & (buf.size() - 1)] = s;
+    }
+
+    State pop() { return buf[head++ & (buf.size() - 1)]; }
+
+    void grow() {
+        std::vector<State> bigger(buf.size() * 2);
+        for (size_t i = head; i < tail; ++i) bigger[i - head] = buf[i & (buf.size() - 1)];
+        tail -= head;
+        head = 0;
+        buf.swap(bigger);
+    }
+};
+
+/**
+ * @brief Calls `visit(next)` for every state one move away from `s`.
+ * * Stops early, returning true, as soon as `visit` returns true.
+ */
+template <typename Visit>
+inline bool for_each_move(State s, Visit visit) {
+    int ct = (int)(s / C), ch = (int)(s % C);
+
+    // Explore all 8 possible moves from the current hole position
+    for (int i = 0; i < 8; ++i) {
+        int tile = ch + delta[i];
+        if (blocked[tile]) continue;
+
+        // The moved tile lands in the old hole; the hole takes its place.
+        int nt = (tile == ct) ? ch : ct;
+        if (visit(pack(nt, tile), nt)) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Breadth-first search from (target, hole) until the target reaches (N, M).
+ * * @param visited Empty set of packed states, a `VisitedBitmap` or a `FlatStateSet`.
+ * @return The minimum number of moves, or -1 if the goal is unreachable.
+ */
+template <typename Visited>
+int bfs(int target, int hole, Visited& visited) {
+    if (target == goal) return 0;
+
+    RingQueue q(std::min<size_t>(8 * (size_t)N * M, 1 << 20));
+    visited.test_and_set(pack(target, hole));
+    q.push(pack(target, hole));
+
+    for (int moves = 1; !q.empty(); ++moves) {
+        // Expand one whole level; every state pushed here is `moves` moves away
+        for (size_t level = q.size(); level > 0; --level) {
+            ++expanded;
+            bool found = for_each_move(q.pop(), [&](State ns, int nt) {
+                if (visited.test_and_set(ns)) return false;
+                if (nt == goal) return true;
+                q.push(ns);
+                return false;
+            });
+            if (found) return moves;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Runs `bfs()` with a `VisitedBitmap` when it fits in `DENSE_LIMIT` bits (1 GiB, i.e.
+ * $(N + 2)(M + 2) \le 92681$, up to about $302 \times 302$), and with a `FlatStateSet` otherwise.
+ */
+const State DENSE_LIMIT = State(1) << 33;
+
+int bfs(int target, int hole) {
+    if ((State)C * C <= DENSE_LIMIT) {
+        VisitedBitmap visited((State)C * C);
+        return bfs(target, hole, visited);
+    }
+    FlatStateSet visited;
+    return bfs(target, hole, visited);
+}
+
+/**
+ * @brief The direction of the move that first reached each state, 3 bits per state.
+ * * Bit `k` of the direction is kept in its own `VisitedBitmap`, so the three planes come
+ * lazily zeroed and are indexed by the packed state exactly like `visited`.
+ */
+struct DirectionArray {
+    VisitedBitmap plane[3];
+
+    explicit DirectionArray(State states)
+        : plane{VisitedBitmap(states), VisitedBitmap(states), VisitedBitmap(states)} {}
+
+    void set(State s, int dir) {
+        for (int k = 0; k < 3; ++k)
+            if (dir >> k & 1) plane[k].test_and_set(s);
+    }
+    int get(State s) const { return plane[0].test(s) | plane[1].test(s) << 1 | plane[2].test(s) << 2; }
+};
+
+/**
+ * @brief BFS that also returns the moves (`--moves` mode).
+ * * Alongside `visited`, each new state records the direction `i` of its move: the tile at
+ * `hole + delta[i]` slid into the hole. That is enough to undo the move, so the path is rebuilt
+ * by walking back from the goal state: the previous hole is `hole - delta[i]`, and the target
+ * was at the current hole if it is now on the previous one.
+ * @param path Receives the cell of the tile moved at each step, in order.
+ * @return The minimum number of moves, or -1 if the goal is unreachable.
+ */
+int bfs_path(int target, int hole, std::vector<int>& path) {
+    path.clear();
+    if (target == goal) return 0;
+
+    VisitedBitmap visited((State)C * C);
+    DirectionArray came_from((State)C * C);
+    RingQueue q(8 * (size_t)N * M);
+    visited.test_and_set(pack(target, hole));
+    q.push(pack(target, hole));
+
+    for (int moves = 1; !q.empty(); ++moves) {
+        for (size_t level = q.size(); level > 0; --level) {
+            ++expanded;
+            State s = q.pop();
+            int ch = (int)(s % C);
+            State last = 0;
+            bool found = for_each_move(s, [&](State ns, int nt) {
+                if (visited.test_and_set(ns)) return false;
+                int dir = 0;
+                while (delta[dir] != (int)(ns % C) - ch) ++dir;
+                came_from.set(ns, dir);
+                if (nt == goal) {
+                    last = ns;
+                    return true;
                 }
+                q.push(ns);
+                return false;
+            });
+            if (!found) continue;
+
+            // Undo the moves one by one, from the goal state back to the start
+            path.resize(moves);
+            for (int k = moves - 1; k >= 0; --k) {
+                int t = (int)(last / C), h = (int)(last % C);
+                int ph = h - delta[came_from.get(last)];
+                path[k] = h;
+                last = pack(t == ph ? h : t, ph);
             }
+            return moves;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Reusable barrier for a fixed number of threads (`std::barrier` needs C++20).
+ * * A generation counter tells waiters of one round apart from arrivals of the next.
+ */
+struct LevelBarrier {
+    std::mutex mutex;
+    std::condition_variable cv;
+    int count, arrived = 0;
+    unsigned long generation = 0;
+
+    explicit LevelBarrier(int count) : count(count) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        unsigned long gen = generation;
+        if (++arrived == count) {
+            arrived = 0;
+            ++generation;
+            cv.notify_all();
+            return;
         }
+        cv.wait(lock, [&] { return generation != gen; });
     }
+};
 
-    // If the queue becomes empty and the target has not been moved to the destination,
-    // it means the goal is unreachable.
-    std::cout << -1 << std::endl;
+/**
+ * @brief Level-synchronous BFS on `threads` threads (`--parallel` mode).
+ * * The current level is a flat vector. Threads grab `CHUNK` states at a time from a shared
+ * counter, which keeps them busy even when some states have more free moves than others.
+ * The per-thread next frontiers are concatenated once the level is done.
+ * * The workers are started once and meet the calling thread at a barrier before and after each
+ * level. A level too small to give every thread a chunk is expanded by the calling thread alone
+ * and the workers stay asleep, so long narrow searches, whose frontiers stay small for thousands
+ * of levels, pay for no wake-ups.
+ * @return The minimum number of moves, or -1 if the goal is unreachable.
+ */
+int parallel_bfs(int target, int hole, int threads) {
+    if (target == goal) return 0;
+    const size_t CHUNK = 1024;
+
+    VisitedBitmap visited((State)C * C);
+    std::vector<State> frontier(1, pack(target, hole));
+    std::vector<std::vector<State>> next(threads);
+    std::vector<long long> work(threads, 0);
+    visited.test_and_set(frontier[0]);
+
+    // Written by the calling thread between levels only; the barrier publishes them
+    std::atomic<size_t> cursor(0);
+    std::atomic<bool> found(false);
+    bool stop = false;
+
+    auto expand = [&](int id) {
+        std::vector<State>& out = next[id];
+        out.clear();
+        long long done = 0;
+        size_t begin;
+        while (!found.load(std::memory_order_relaxed) &&
+               (begin = cursor.fetch_add(CHUNK, std::memory_order_relaxed)) < frontier.size()) {
+            size_t end = std::min(begin + CHUNK, frontier.size());
+            for (size_t i = begin; i < end; ++i) {
+                ++done;
+                bool hit = for_each_move(frontier[i], [&](State ns, int nt) {
+                    if (visited.atomic_test_and_set(ns)) return false;
+                    if (nt == goal) return true;
+                    out.push_back(ns);
+                    return false;
+                });
+                if (hit) {
+                    found.store(true, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+        work[id] = done;
+    };
+
+    LevelBarrier barrier(threads);
+    std::vector<std::thread> pool;
+    for (int id = 1; id < threads; ++id)
+        pool.emplace_back([&, id] {
+            for (;;) {
+                barrier.wait();  // level start
+                if (stop) return;
+                expand(id);
+                barrier.wait();  // level end
+            }
+        });
+
+    int answer = -1;
+    for (int moves = 1; !frontier.empty(); ++moves) {
+        cursor.store(0, std::memory_order_relaxed);
+        int active = frontier.size() < threads * CHUNK ? 1 : threads;
+        if (active == 1) {
+            expand(0);
+        } else {
+            barrier.wait();
+            expand(0);
+            barrier.wait();
+        }
+
+        for (int id = 0; id < active; ++id) expanded += work[id];
+        if (found) {
+            answer = moves;
+            break;
+        }
+
+        frontier.clear();
+        for (int id = 0; id < active; ++id)
+            frontier.insert(frontier.end(), next[id].begin(), next[id].end());
+    }
+
+    stop = true;
+    if (!pool.empty()) barrier.wait();
+    for (std::thread& th : pool) th.join();
+    return answer;
+}
+
+/**
+ * @brief Bidirectional BFS between the start state and the goal states (`--bidir` mode).
+ * * Each round expands one whole level of the side with the smaller frontier. Every new state is
+ * checked against the other side, so the two visited sets stay disjoint until they meet. With
+ * forward depth `df` and backward depth `db` fully explored without meeting, the answer is at
+ * least `df + db + 1`; so the first state of the next level found in the other set closes a
+ * shortest path of exactly that length.
+ * @return The minimum number of moves, or -1 if the goal is unreachable.
+ */
+int bidirectional(int target, int hole) {
+    if (target == goal) return 0;
+
+    VisitedBitmap fwd_seen((State)C * C), bwd_seen((State)C * C);
+    RingQueue fwd(8 * (size_t)N * M), bwd(8 * (size_t)N * M);
+    fwd_seen.test_and_set(pack(target, hole));
+    fwd.push(pack(target, hole));
+    for (int i = 0; i < 8; ++i) {
+        int h = goal + delta[i];
+        if (blocked[h]) continue;
+        bwd_seen.test_and_set(pack(goal, h));
+        bwd.push(pack(goal, h));
+    }
+
+    int depth[2] = {0, 0};  // fully explored levels: forward, backward
+    while (!fwd.empty() && !bwd.empty()) {
+        int side = fwd.size() <= bwd.size() ? 0 : 1;
+        RingQueue& q = side == 0 ? fwd : bwd;
+        VisitedBitmap& mine = side == 0 ? fwd_seen : bwd_seen;
+        VisitedBitmap& other = side == 0 ? bwd_seen : fwd_seen;
+
+        for (size_t level = q.size(); level > 0; --level) {
+            ++expanded;
+            bool met = for_each_move(q.pop(), [&](State ns, int) {
+                if (mine.test_and_set(ns)) return false;
+                if (other.test(ns)) return true;
+                q.push(ns);
+                return false;
+            });
+            if (met) return depth[0] + depth[1] + 1;
+        }
+        ++depth[side];
+    }
+    return -1;
+}
+
+/**
+ * @brief Scratch space for the hole searches of the reduced mode.
+ * * `hole_seen[c] == hole_stamp` marks the cells reached by the current search, so starting a new
+ * search is a counter increment instead of clearing an array.
+ */
+std::vector<int> hole_seen, hole_dist, hole_queue;
+int hole_stamp = 0;
+
+/**
+ * @brief BFS of the hole from cell `from` while the target stays at `t`.
+ * * Stops as soon as every free neighbour of `t` has been reached.
+ * @param dist Receives, for each direction `i`, the number of moves that bring the hole to
+ * `t + delta[i]`, or -1 if that cell cannot be reached.
+ */
+void hole_distances(int from, int t, int* dist) {
+    int remaining = 0;
+    for (int i = 0; i < 8; ++i) {
+        dist[i] = -1;
+        if (!blocked[t + delta[i]]) ++remaining;
+    }
+
+    ++hole_stamp;
+    hole_seen[t] = hole_stamp;  // the hole may not pass through the target
+    hole_seen[from] = hole_stamp;
+    hole_dist[from] = 0;
+    hole_queue.clear();
+    hole_queue.push_back(from);
+
+    for (size_t head = 0; head < hole_queue.size() && remaining > 0; ++head) {
+        int c = hole_queue[head];
+        for (int i = 0; i < 8; ++i) {
+            if (c == t + delta[i]) {
+                dist[i] = hole_dist[c];
+                --remaining;
+            }
+        }
+        for (int i = 0; i < 8; ++i) {
+            int next = c + delta[i];
+            if (blocked[next] || hole_seen[next] == hole_stamp) continue;
+            hole_seen[next] = hole_stamp;
+            hole_dist[next] = hole_dist[c] + 1;
+            hole_queue.push_back(next);
+        }
+    }
+}
+
+/**
+ * @brief Dijkstra over the reduced `(target, direction)` graph (`--reduced` mode).
+ * * State `t * 8 + a` means the target is at `t` and the hole at `t + delta[a]`. Direction `7 - a`
+ * is the opposite of `a`, so sliding the target leads to state `(t + delta[a]) * 8 + (7 - a)`.
+ * The hole distances between the neighbours of `t` are computed the first time a state around
+ * `t` is settled and cached in `around`.
+ * @return The minimum number of moves, or -1 if the goal is unreachable.
+ */
+int reduced(int target, int hole) {
+    if (target == goal) return 0;
+
+    hole_seen.assign(C, 0);
+    hole_dist.assign(C, 0);
+    hole_queue.reserve(C);
+
+    const int INF = 0x3f3f3f3f;
+    std::vector<int> dist((size_t)C * 8, INF);
+    std::vector<int> around((size_t)C * 64);
+    std::vector<char> around_done((size_t)C * 8, 0);
+
+    typedef std::pair<int, int> Item;  // (moves, state)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> pq;
+    auto relax = [&](int s, int d) {
+        if (d < dist[s]) {
+            dist[s] = d;
+            pq.push(Item(d, s));
+        }
+    };
+
+    // First bring the hole next to the target.
+    int first[8];
+    hole_distances(hole, target, first);
+    for (int a = 0; a < 8; ++a)
+        if (first[a] >= 0) relax(target * 8 + a, first[a]);
+
+    while (!pq.empty()) {
+        Item top = pq.top();
+        pq.pop();
+        int d = top.first, s = top.second;
+        if (d > dist[s]) continue;
+        ++expanded;
+        int t = s >> 3, a = s & 7;
+        if (t == goal) return d;
+
+        // Slide the target into the hole.
+        relax((t + delta[a]) * 8 + (7 - a), d + 1);
+
+        // Move the hole around the target to another neighbour.
+        int* row = &around[(size_t)s * 8];
+        if (!around_done[s]) {
+            hole_distances(t + delta[a], t, row);
+            around_done[s] = 1;
+        }
+        for (int b = 0; b < 8; ++b)
+            if (row[b] > 0) relax(t * 8 + b, d + row[b]);
+    }
+    return -1;
+}
+
+/**
+ * @brief Lower bound on the number of moves left from (target `t`, hole), see the header.
+ */
+int heuristic(int t, int hole) {
+    if (t == goal) return 0;
+    int tx = t / W, ty = t % W, hx = hole / W, hy = hole % W;
+    int c = std::max(N - tx, M - ty);
+
+    // Distance from the hole to the nearest neighbour of the target that is closer to (N, M)
+    int q = INT_MAX;
+    for (int i = 0; i < 8; ++i) {
+        int nx = tx + dx[i], ny = ty + dy[i];
+        if (std::max(std::abs(N - nx), std::abs(M - ny)) >= c) continue;
+        q = std::min(q, std::max(std::abs(hx - nx), std::abs(hy - ny)));
+    }
+    return 3 * c - 2 + q;
+}
+
+/**
+ * @brief A* over the full state space (`--astar` mode).
+ * * All moves cost 1 and the heuristic is consistent, so `f = g + h` never decreases along an
+ * expansion and the open list is a bucket queue indexed by `f`. Only the state is stored;
+ * its `g` is recovered as `f - h`. A state may be queued more than once, but the first copy
+ * taken off the queue has the smallest `g`; `closed` skips the others. Within a bucket the
+ * most recently pushed (deepest) state is expanded first.
+ * @return The minimum number of moves, or -1 if the goal is unreachable.
+ */
+int astar(int target, int hole) {
+    VisitedBitmap closed((State)C * C);
+    std::vector<std::vector<State>> buckets(heuristic(target, hole) + 1);
+    buckets.back().push_back(pack(target, hole));
+
+    for (size_t f = 0; f < buckets.size(); ++f) {
+        while (!buckets[f].empty()) {
+            State s = buckets[f].back();
+            buckets[f].pop_back();
+            if (closed.test_and_set(s)) continue;
+            int t = (int)(s / C);
+            int g = (int)f - heuristic(t, (int)(s % C));
+            if (t == goal) return g;
+
+            ++expanded;
+            for_each_move(s, [&](State ns, int nt) {
+                if (closed.test(ns)) return false;
+                size_t nf = g + 1 + heuristic(nt, (int)(ns % C));
+                if (nf >= buckets.size()) buckets.resize(nf + 1);
+                buckets[nf].push_back(ns);
+                return false;
+            });
+        }
+        std::vector<State>().swap(buckets[f]);
+    }
+    return -1;
+}
+
+/**
+ * @brief Fixed-size transposition table of IDA*.
+ * * Remembers the smallest `g` a state was entered with during the current iteration, so the
+ * many paths that reach the same state are searched once. It is direct-mapped and lossy: a
+ * collision overwrites the slot, which only costs some re-expansion. Its size does not depend on
+ * the board.
+ */
+struct TransEntry {
+    State s;
+    int g, iteration;
+};
+const int TRANS_BITS = 20;
+std::vector<TransEntry> trans_table;
+int ida_iteration;
+bool ida_found;
+
+/**
+ * @brief Depth-first search of IDA*: explores the paths with `g + h <= bound`.
+ * * The move that would undo the previous one (sliding the tile back into `prev_hole`) is
+ * skipped. Sets `ida_found` when the target reaches (N, M).
+ * @return The smallest `g + h` above `bound` seen, for the next iteration.
+ */
+int ida_search(int t, int hole, int prev_hole, int g, int bound) {
+    int f = g + heuristic(t, hole);
+    if (f > bound) return f;
+    if (t == goal) {
+        ida_found = true;
+        return f;
+    }
+
+    State s = pack(t, hole);
+    TransEntry& e = trans_table[(s * 0x9E3779B97F4A7C15ULL) >> (64 - TRANS_BITS)];
+    if (e.iteration == ida_iteration && e.s == s && e.g <= g) return INT_MAX;
+    e = TransEntry{s, g, ida_iteration};
+
+    ++expanded;
+    int next_bound = INT_MAX;
+    for (int i = 0; i < 8; ++i) {
+        int tile = hole + delta[i];
+        if (blocked[tile] || tile == prev_hole) continue;
+        int nt = (tile == t) ? hole : t;
+        next_bound = std::min(next_bound, ida_search(nt, tile, hole, g + 1, bound));
+        if (ida_found) return next_bound;
+    }
+    return next_bound;
+}
+
+/**
+ * @brief Iterative deepening A* (`--ida` mode), raising the bound to the smallest `f` pruned.
+ * * The depth-first search cannot tell that the goal is unreachable other than by exhausting
+ * every path below the bound, so `reduced()` is asked first whether a solution exists at all.
+ * That call allocates per-cell tables and already computes the exact answer; the IDA* pass that
+ * follows only reproduces it, for comparison with the other searches.
+ * @return The minimum number of moves, or -1 if the goal is unreachable.
+ */
+int ida(int target, int hole) {
+    if (reduced(target, hole) < 0) return -1;
+    expanded = 0;
+
+    trans_table.assign(size_t(1) << TRANS_BITS, TransEntry{0, 0, -1});
+    ida_found = false;
+    for (int bound = heuristic(target, hole);; ++ida_iteration) {
+        int next = ida_search(target, hole, -1, 0, bound);
+        if (ida_found) return next;
+        bound = next;
+    }
+}
+
+/**
+ * @brief Distances of all states to the goal, from one reverse BFS (`--batch` mode).
+ * * `dist[s]` holds the distance of state `s` plus one, so that 0 means "not reached" and the
+ * table can come zeroed from `calloc` like `VisitedBitmap`. The table doubles as the visited set.
+ * The search stops after `LIMIT` levels so the entries fit 16 bits; `truncated` tells whether
+ * that happened, in which case an unreached start may still be solvable.
+ */
+struct DistanceTable {
+    static const int LIMIT = 0xFFFE;
+    std::uint16_t* dist;
+    bool truncated = false;
+
+    DistanceTable() {
+        dist = static_cast<std::uint16_t*>(std::calloc((State)C * C, sizeof(std::uint16_t)));
+        if (!dist) throw std::bad_alloc();
+
+        RingQueue q(8 * (size_t)N * M);
+        for (int i = 0; i < 8; ++i) {
+            int h = goal + delta[i];
+            if (blocked[h]) continue;
+            dist[pack(goal, h)] = 1;
+            q.push(pack(goal, h));
+        }
+
+        for (int moves = 1; !q.empty(); ++moves) {
+            if (moves > LIMIT) {
+                truncated = true;
+                break;
+            }
+            for (size_t level = q.size(); level > 0; --level) {
+                ++expanded;
+                for_each_move(q.pop(), [&](State ns, int) {
+                    if (dist[ns]) return false;
+                    dist[ns] = (std::uint16_t)(moves + 1);
+                    q.push(ns);
+                    return false;
+                });
+            }
+        }
+    }
+    ~DistanceTable() { std::free(dist); }
+    DistanceTable(const DistanceTable&) = delete;
+    DistanceTable& operator=(const DistanceTable&) = delete;
+
+    /**
+     * @return The minimum number of moves from (target, hole), or -1 if the goal is unreachable.
+     */
+    int query(int target, int hole) const {
+        if (target == goal) return 0;
+        std::uint16_t d = dist[pack(target, hole)];
+        if (d) return d - 1;
+        return truncated ? bfs(target, hole) : -1;
+    }
+};
+
+/**
+ * @brief Reads the queries that follow the board and answers them from one `DistanceTable`.
+ */
+void batch(int target, int hole) {
+    DistanceTable table;
+    std::cout << table.query(target, hole) << '\n';
+
+    int Q;
+    std::cin >> Q;
+    for (int i = 0; i < Q; ++i) {
+        int xt, yt, xh, yh;
+        std::cin >> xt >> yt >> xh >> yh;
+        std::cout << table.query(cell(xt, yt), cell(xh, yh)) << '\n';
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::ios_base::sync_with_stdio(false);
+    std::cin.tie(NULL);
+
+    int target, hole;
+    read_board(target, hole);
+
+    std::string mode = argc > 1 ? argv[1] : "";
+    bool stats = false;
+    for (int i = 1; i < argc; ++i) stats |= std::string(argv[i]) == "--stats";
+
+    if (mode == "--reduced") {
+        std::cout << reduced(target, hole) << std::endl;
+    } else if (mode == "--bidir") {
+        std::cout << bidirectional(target, hole) << std::endl;
+    } else if (mode == "--moves") {
+        std::vector<int> path;
+        int moves = bfs_path(target, hole, path);
+        std::cout << moves << '\n';
+        // Each move: the tile's cell, then the cell of the hole it slides into
+        for (int tile : path) {
+            std::cout << tile / W << ' ' << tile % W << ' ' << hole / W << ' ' << hole % W << '\n';
+            hole = tile;
+        }
+    } else if (mode == "--parallel") {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 0;
+        if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        std::cout << parallel_bfs(target, hole, threads) << std::endl;
+    } else if (mode == "--batch") {
+        batch(target, hole);
+    } else if (mode == "--astar") {
+        std::cout << astar(target, hole) << std::endl;
+    } else if (mode == "--ida") {
+        std::cout << ida(target, hole) << std::endl;
+    } else {
+        std::cout << bfs(target, hole) << std::endl;
+    }
+    if (stats) std::cerr << "states expanded: " << expanded << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}
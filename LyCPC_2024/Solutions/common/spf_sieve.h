@@ -0,0 +1,377 @@
+#ifndef LYCPC_SPF_SIEVE_H
+#define LYCPC_SPF_SIEVE_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @file spf_sieve.h
+ * @date 2025-09-20
+ * @brief Smallest-prime-factor sieve shared by the divisor-based solutions (problems B and F).
+ * @details
+ * A linear sieve fills `spf[v]`, the smallest prime factor of every $v \le limit$, and the list
+ * of primes up to `limit`, in $O(limit)$. A value $v \le limit$ is then factorized in
+ * $O(\log v)$ by repeatedly dividing by `spf[v]`. Larger values are trial-divided by the sieved
+ * primes below `SMALL_PRIMES`, and the remaining cofactor is split with Pollard's rho (Brent's
+ * variant) until every part either fits in the table or passes a deterministic Miller-Rabin test.
+ * Both use Montgomery multiplication on 128-bit products, so any 64-bit value is factorized in
+ * microseconds. Divisors are generated already sorted, by merging the sorted lists
+ * $D, D p, \ldots, D p^e$ for each prime power.
+ * The table can be saved to a file and mapped back read-only with `mmap`, so that many runs
+ * share one copy through the page cache instead of each rebuilding it.
+ */
+
+/**
+ * @brief Arithmetic modulo an odd `n` in Montgomery form, with $R = 2^{64}$.
+ */
+struct Montgomery
+{
+    std::uint64_t n, inv, r2;  // inv = n^{-1} mod 2^64, r2 = R^2 mod n
+
+    explicit Montgomery(std::uint64_t n) : n(n)
+    {
+        inv = n;  // Newton iteration: each step doubles the number of correct low bits
+        for (int i = 0; i < 5; ++i)
+            inv *= 2 - n * inv;
+        r2 = (std::uint64_t)(-(unsigned __int128)n % n);
+    }
+
+    // t R^{-1} mod n for t < n R: m n has the same low 64 bits as t, so only the high halves
+    // are subtracted and nothing overflows even for n close to 2^64
+    std::uint64_t reduce(unsigned __int128 t) const
+    {
+        std::uint64_t m = (std::uint64_t)t * inv;
+        std::uint64_t hi = (std::uint64_t)(t >> 64), mn = (std::uint64_t)(((unsigned __int128)m * n) >> 64);
+        return hi >= mn ? hi - mn : hi - mn + n;
+    }
+
+    std::uint64_t to(std::uint64_t a) const { return reduce((unsigned __int128)a * r2); }
+    std::uint64_t from(std::uint64_t a) const { return reduce(a); }
+    std::uint64_t mul(std::uint64_t a, std::uint64_t b) const { return reduce((unsigned __int128)a * b); }
+};
+
+/**
+ * @brief Deterministic Miller-Rabin test for an odd `n > 2`; these 12 bases are enough below $2^{64}$.
+ */
+inline bool is_prime_odd(std::uint64_t n)
+{
+    Montgomery m(n);
+    std::uint64_t d = n - 1;
+    int s = 0;
+    while (d % 2 == 0)
+    {
+        d /= 2;
+        ++s;
+    }
+    const std::uint64_t one = m.to(1), minus_one = m.to(n - 1);
+    for (std::uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37})
+    {
+        if (a % n == 0)
+            continue;
+        std::uint64_t x = one, base = m.to(a % n);
+        for (std::uint64_t e = d; e; e >>= 1, base = m.mul(base, base))
+            if (e & 1)
+                x = m.mul(x, base);
+        if (x == one || x == minus_one)
+            continue;
+        bool composite = true;
+        for (int r = 1; r < s && composite; ++r)
+        {
+            x = m.mul(x, x);
+            composite = x != minus_one;
+        }
+        if (composite)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief A non-trivial factor of an odd composite `n`, by Brent's variant of Pollard's rho.
+ * * Differences are multiplied together in blocks of `BLOCK` and a single gcd is taken per block;
+ * when that gcd jumps to `n` the block is replayed one step at a time.
+ */
+inline std::uint64_t pollard_rho(std::uint64_t n)
+{
+    const int BLOCK = 128;
+    Montgomery m(n);
+    for (std::uint64_t c = 1;; ++c)
+    {
+        const std::uint64_t mc = m.to(c);
+        auto f = [&](std::uint64_t x) { return m.reduce((unsigned __int128)x * x + mc); };
+        std::uint64_t x = m.to(2), y = x, ys = x, q = m.to(1), g = 1;
+        for (std::uint64_t r = 1; g == 1; r <<= 1)
+        {
+            x = y;
+            for (std::uint64_t i = 0; i < r; ++i)
+                y = f(y);
+            for (std::uint64_t k = 0; k < r && g == 1; k += BLOCK)
+            {
+                ys = y;
+                for (std::uint64_t i = 0; i < BLOCK && i < r - k; ++i)
+                {
+                    y = f(y);
+                    q = m.mul(q, x > y ? x - y : y - x);
+                }
+                g = std::gcd(m.from(q), n);
+            }
+        }
+        if (g == n)
+        {
+            do
+            {
+                ys = f(ys);
+                g = std::gcd(x > ys ? x - ys : ys - x, n);
+            } while (g == 1);
+        }
+        if (g != n)
+            return g;
+    }
+}
+
+/**
+ * @brief Header of a saved sieve file: the header is followed by `spf[0..limit]` and then
+ * the `prime_count` primes, all as native 32-bit integers.
+ */
+struct SpfSieveHeader
+{
+    char magic[8];
+    std::uint64_t limit, prime_count;
+};
+
+const char SPF_SIEVE_MAGIC[8] = {'S', 'P', 'F', 'S', 'I', 'E', 'V', '1'};
+
+/**
+ * @brief Sieve size used by every solution, so they can share one saved file.
+ * * Pollard's rho handles the larger cofactors, so a bigger table only costs build time.
+ */
+const std::uint32_t SIEVE_LIMIT = 1 << 16;
+
+struct SpfSieve
+{
+    static const std::uint32_t SMALL_PRIMES = 1 << 10;
+
+    std::uint32_t limit = 0;
+    const std::uint32_t* spf = nullptr;     // spf[v] for 2 <= v <= limit
+    const std::uint32_t* primes = nullptr;  // the primes up to limit, increasing
+    std::size_t prime_count = 0;
+
+    std::vector<std::uint32_t> spf_storage, prime_storage;  // empty when mapped
+    void* mapping = nullptr;
+    std::size_t mapping_size = 0;
+
+    SpfSieve() = default;
+    SpfSieve(const SpfSieve&) = delete;
+    SpfSieve& operator=(const SpfSieve&) = delete;
+    ~SpfSieve() { unmap(); }
+
+    /**
+     * @brief Releases the mapping made by `map()`, if any.
+     */
+    void unmap()
+    {
+        if (mapping)
+            munmap(mapping, mapping_size);
+        mapping = nullptr;
+        mapping_size = 0;
+        spf = primes = nullptr;
+        limit = 0;
+        prime_count = 0;
+    }
+
+    /**
+     * @brief Builds the table for all values up to `n` with a linear sieve.
+     * * Every composite $v$ is written exactly once, as $p \cdot i$ with $p$ = spf[v].
+     */
+    void build(std::uint32_t n)
+    {
+        limit = std::max<std::uint32_t>(n, 2);
+        spf_storage.assign((std::size_t)limit + 1, 0);
+        prime_storage.clear();
+        for (std::uint32_t i = 2; i <= limit; ++i)
+        {
+            if (spf_storage[i] == 0)
+            {
+                spf_storage[i] = i;
+                prime_storage.push_back(i);
+            }
+            for (std::uint32_t p : prime_storage)
+            {
+                if (p > spf_storage[i] || (std::uint64_t)p * i > limit)
+                    break;
+                spf_storage[p * i] = p;
+            }
+        }
+        spf = spf_storage.data();
+        primes = prime_storage.data();
+        prime_count = prime_storage.size();
+    }
+
+    /**
+     * @brief Writes the table to `path` in the format read by `map()`.
+     * * The file is written under a temporary name and then renamed over `path`, so processes
+     * that have the old file mapped keep their (unchanged) copy instead of seeing it truncated.
+     * @return `true` on success.
+     */
+    bool save(const char* path) const
+    {
+        SpfSieveHeader h = {};
+        std::memcpy(h.magic, SPF_SIEVE_MAGIC, 8);
+        h.limit = limit;
+        h.prime_count = prime_count;
+
+        std::string tmp = std::string(path) + ".tmp." + std::to_string(getpid());
+        std::FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f)
+            return false;
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+                  std::fwrite(spf, 4, (std::size_t)limit + 1, f) == (std::size_t)limit + 1 &&
+                  std::fwrite(primes, 4, prime_count, f) == prime_count;
+        ok = std::fclose(f) == 0 && ok && std::rename(tmp.c_str(), path) == 0;
+        if (!ok)
+            std::remove(tmp.c_str());
+        return ok;
+    }
+
+    /**
+     * @brief Maps a file written by `save()` read-only; the table is used in place.
+     * @return `true` if the file exists and looks like a valid sieve.
+     */
+    bool map(const char* path)
+    {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SpfSieveHeader))
+        {
+            close(fd);
+            return false;
+        }
+        void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED)
+            return false;
+
+        SpfSieveHeader h;
+        std::memcpy(&h, base, sizeof(h));
+        if (std::memcmp(h.magic, SPF_SIEVE_MAGIC, 8) != 0 ||
+            (std::uint64_t)st.st_size != sizeof(h) + 4 * (h.limit + 1 + h.prime_count))
+        {
+            munmap(base, st.st_size);
+            return false;
+        }
+        mapping = base;
+        mapping_size = st.st_size;
+        limit = (std::uint32_t)h.limit;
+        prime_count = h.prime_count;
+        spf = reinterpret_cast<const std::uint32_t*>(static_cast<const char*>(base) + sizeof(h));
+        primes = spf + limit + 1;
+        return true;
+    }
+
+    /**
+     * @brief Maps the sieve saved at `path`, or builds one up to `n` and saves it there.
+     * * A saved table that is too small is unmapped before the new one replaces it.
+     */
+    void load_or_build(const char* path, std::uint32_t n)
+    {
+        if (path && map(path))
+        {
+            if (limit >= n)
+                return;
+            unmap();
+        }
+        build(n);
+        if (path)
+            save(path);
+    }
+
+    /**
+     * @brief Prime factorization of `v` (`v >= 1`) as (prime, exponent) pairs, by increasing prime.
+     */
+    std::vector<std::pair<std::uint64_t, int>> factorize(std::uint64_t v) const
+    {
+        std::vector<std::uint64_t> found;  // prime factors with multiplicity, in any order
+
+        if (v > limit)
+        {
+            // Strip the small primes, which Pollard's rho is worst at finding
+            for (std::size_t i = 0; i < prime_count && primes[i] < SMALL_PRIMES; ++i)
+                while (v % primes[i] == 0)
+                {
+                    v /= primes[i];
+                    found.push_back(primes[i]);
+                }
+        }
+
+        std::vector<std::uint64_t> parts = {v};
+        while (!parts.empty())
+        {
+            std::uint64_t x = parts.back();
+            parts.pop_back();
+            if (x <= limit)
+            {
+                for (; x > 1; x /= spf[x])
+                    found.push_back(spf[x]);
+            }
+            else if (x % 2 != 0 && is_prime_odd(x))
+            {
+                found.push_back(x);
+            }
+            else
+            {
+                std::uint64_t d = x % 2 == 0 ? 2 : pollard_rho(x);
+                parts.push_back(d);
+                parts.push_back(x / d);
+            }
+        }
+
+        std::sort(found.begin(), found.end());
+        std::vector<std::pair<std::uint64_t, int>> factors;
+        for (std::uint64_t p : found)
+        {
+            if (factors.empty() || factors.back().first != p)
+                factors.push_back({p, 0});
+            ++factors.back().second;
+        }
+        return factors;
+    }
+
+    /**
+     * @brief All divisors of `v` (`v >= 1`) in increasing order, built from its factorization.
+     * * For each prime power $p^e$, the sorted divisors $D$ found so far give the sorted lists
+     * $D, D p, \ldots, D p^e$. They are merged into the result one after another with linear
+     * merges (exponents are small), so no final sort is needed.
+     */
+    std::vector<std::uint64_t> divisors(std::uint64_t v) const
+    {
+        std::vector<std::uint64_t> divs = {1}, scaled, merged;
+        for (auto [p, e] : factorize(v))
+        {
+            std::size_t count = divs.size();
+            scaled.assign(divs.begin(), divs.end());
+            for (int k = 1; k <= e; ++k)
+            {
+                for (std::uint64_t& d : scaled)
+                    d *= p;
+                merged.resize(divs.size() + count);
+                std::merge(divs.begin(), divs.end(), scaled.begin(), scaled.end(), merged.begin());
+                divs.swap(merged);
+            }
+        }
+        return divs;
+    }
+};
+
+#endif
@@ -1,28 +1,68 @@
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <cstdlib>
+#include <string>
+
+#include "../common/spf_sieve.h"
 
 using namespace std;
 
+// The unsafe values in [N, M] are the common divisors of X1 and X2,
+// i.e. the divisors of g = gcd(X1, X2). Each test factorizes g with the
+// shared smallest-prime-factor sieve, builds its sorted divisor list and
+// counts the ones inside [N, M] with two binary searches. Divisor lists
+// are cached by g across test cases.
+// Run as `B --sieve <file>` to map the sieve from <file>, building and
+// saving it there on the first run.
+
+SpfSieve sieve;
+unordered_map<long long, vector<long long>> divisor_cache;
+
+const vector<long long>& divisors(long long g)
+{
+    auto it = divisor_cache.find(g);
+    if (it != divisor_cache.end())
+        return it->second;
+
+    vector<uint64_t> divs = sieve.divisors(g);
+
+    return divisor_cache[g] = vector<long long>(divs.begin(), divs.end());
+}
+
 void solve()
 {
-    int N, M, X1, X2;
+    long long N, M, X1, X2;
 
     cin >> N >> M >> X1 >> X2;
 
-    int unsave = 0;
+    long long g = gcd(llabs(X1), llabs(X2));
+
+    // Every value divides 0, so nothing is safe
+    if (g == 0)
+    {
+        cout << 0;
+        return;
+    }
 
-    for (int i = N; i < M + 1; i++)
-        if ((X1 % i) == 0 && (X2 % i) == 0)
-            unsave++;
+    const vector<long long>& divs = divisors(g);
+    long long unsave = upper_bound(divs.begin(), divs.end(), M) -
+                       lower_bound(divs.begin(), divs.end(), N);
 
-    cout << (M - N + 1) - unsave;
+    cout << (M - N + 1) - max(unsave, 0LL);
 }
 
-int main(void)
+int main(int argc, char* argv[])
 {
     ios_base::sync_with_stdio(0);
     cin.tie(nullptr);
     cout.tie(nullptr);
 
+    bool persist = argc > 2 && string(argv[1]) == "--sieve";
+    sieve.load_or_build(persist ? argv[2] : nullptr, SIEVE_LIMIT);
+
     int times = 1;
     cin >> times;
 
@@ -31,4 +71,4 @@ int main(void)
         solve();
         cout << '\n';
     }
-}
\ No newline at end of file
+}